@@ -15,4 +15,6 @@ if [ "$1" = "all" ]; then OP="make -j$JOBS all"; shift; fi
 (cd usr/zlibc && $CLEAN && $OP)
 (cd usr/init && $CLEAN && $OP)
 (cd usr/hello && $CLEAN && $OP)
+(cd usr/bench && $CLEAN && $OP)
+(cd usr/defrag && $CLEAN && $OP)
 (cd usr/zesh && $CLEAN && $OP)
@@ -6,19 +6,98 @@
 
 #include <z180/z180.h>
 #include <stdint.h>
+#include <string.h>
+
+#include "critical.h"
+#include "prt.h"
 
 static volatile int8_t active;
 
-void critical_start(void)
+static struct {
+	volatile uint8_t enabled;
+	uint8_t open;
+	uint16_t start;
+	uint16_t site;
+	struct critical_stat stat;
+} measure;
+
+void _critical_window_open(uint16_t site);
+
+/* Called from critical_start(), site in hl */
+void _critical_window_open(uint16_t site)
 {
-	if (active) {
-		__asm di __endasm;
+	if (!measure.open) {
+		measure.open = 1;
+		measure.site = site;
+		measure.start = _prt0_timer_get();
 	}
 }
 
+static void critical_window_close(void)
+{
+	uint16_t now = _prt0_timer_get();
+	uint16_t ticks;
+	uint8_t i, bucket = 0, min = 0;
+
+	measure.open = 0;
+
+	/* PRT0 counts down */
+	if (measure.start >= now) {
+		ticks = measure.start - now;
+	}
+	else {
+		ticks = measure.start + (RLDR0L | ((uint16_t)RLDR0H << 8)) - now;
+	}
+
+	for (uint16_t t = ticks; (t > 1) && (bucket < CRITICAL_HIST - 1); t >>= 1) {
+		++bucket;
+	}
+	++measure.stat.hist[bucket];
+
+	for (i = 0; i < CRITICAL_TOP; ++i) {
+		struct critical_window *w = &measure.stat.top[i];
+
+		if (w->site == measure.site) {
+			if (ticks > w->ticks) {
+				w->ticks = ticks;
+			}
+			return;
+		}
+
+		if (w->ticks < measure.stat.top[min].ticks) {
+			min = i;
+		}
+	}
+
+	if (ticks > measure.stat.top[min].ticks) {
+		measure.stat.top[min].site = measure.site;
+		measure.stat.top[min].ticks = ticks;
+	}
+}
+
+void critical_start(void) __naked
+{
+	/* Naked to get the call site (return address) */
+	__asm
+		ld a, (_active)
+		or a, a
+		ret z
+		di
+		ld a, (_measure + 0)
+		or a, a
+		ret z
+		pop hl
+		push hl
+		jp __critical_window_open
+	__endasm;
+}
+
 void critical_end(void)
 {
 	if (active) {
+		if (measure.open) {
+			critical_window_close();
+		}
 		__asm ei __endasm;
 	}
 }
@@ -27,3 +106,22 @@ void critical_enable(void)
 {
 	active = 1;
 }
+
+void critical_measure(uint8_t enable)
+{
+	critical_start();
+	measure.enabled = 0;
+	if (enable) {
+		memset(&measure.stat, 0, sizeof(measure.stat));
+		measure.enabled = 1;
+	}
+	measure.open = 0;
+	critical_end();
+}
+
+void critical_stat_get(struct critical_stat *stat)
+{
+	critical_start();
+	memcpy(stat, &measure.stat, sizeof(*stat));
+	critical_end();
+}
@@ -7,6 +7,25 @@
 #ifndef DRIVER_CRITICAL_H_
 #define DRIVER_CRITICAL_H_
 
+#include <stdint.h>
+
+/* Interrupts-disabled windows, log2 of PRT0 ticks (CPU_FREQ / 20).
+ * Windows longer than the PRT0 reload period are aliased. */
+#define CRITICAL_HIST 12
+
+/* Worst windows, one per call site */
+#define CRITICAL_TOP 8
+
+struct critical_window {
+	uint16_t site;
+	uint16_t ticks;
+};
+
+struct critical_stat {
+	uint16_t hist[CRITICAL_HIST];
+	struct critical_window top[CRITICAL_TOP];
+};
+
 void critical_start(void);
 
 
@@ -15,4 +34,9 @@ void critical_end(void);
 
 void critical_enable(void);
 
+/* Enabling resets the statistics */
+void critical_measure(uint8_t enable);
+
+void critical_stat_get(struct critical_stat *stat);
+
 #endif
@@ -47,12 +47,17 @@ uint32_t prt_val_to_ms(uint16_t val)
 	return ((uint32_t)val * 1000) / (CPU_FREQ / 20);
 }
 
+uint16_t prt_ms_to_val(uint8_t ms)
+{
+	return ((CPU_FREQ / 20) * (uint32_t)ms) / 1000;
+}
+
 void prt0_init(uint8_t interval)
 {
 	/* Disable timer and its interrupt */
 	TCR &= ~((1 << 4) | 1);
 
-	uint16_t reload = ((CPU_FREQ / 20) * (uint32_t)interval) / 1000;
+	uint16_t reload = prt_ms_to_val(interval);
 
 	RLDR0L = reload & 0xFF;
 	RLDR0H = reload >> 8;
@@ -66,7 +71,7 @@ void prt1_init(uint8_t interval)
 	/* Disable timer and its interrupt */
 	TCR &= ~((1 << 5) | (1 << 1));
 
-	uint16_t reload = ((CPU_FREQ / 20) * (uint32_t)interval) / 1000;
+	uint16_t reload = prt_ms_to_val(interval);
 
 	RLDR1L = reload & 0xFF;
 	RLDR1H = reload >> 8;
@@ -74,3 +79,8 @@ void prt1_init(uint8_t interval)
 	/* Enable timer and its interrupt */
 	TCR |= (1 << 5) | (1 << 1);
 }
+
+void prt1_disable(void)
+{
+	TCR &= ~((1 << 5) | (1 << 1));
+}
@@ -19,10 +19,14 @@ uint16_t prt1_timer_get(void);
 
 uint32_t prt_val_to_ms(uint16_t val);
 
+uint16_t prt_ms_to_val(uint8_t ms);
+
 /* Interval in miliseconds */
 
 void prt0_init(uint8_t interval);
 
-void prt0_init(uint8_t interval);
+void prt1_init(uint8_t interval);
+
+void prt1_disable(void);
 
 #endif
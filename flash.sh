@@ -8,6 +8,8 @@ ROOTFS_SKEL=rootfs
 cp kernel/kernel.bin $ROOTFS_SKEL/BOOT/KERNEL.IMG
 cp usr/init/init.bin $ROOTFS_SKEL/BOOT/INIT.ZEX
 cp usr/hello/hello.bin $ROOTFS_SKEL/BIN/HELLO.ZEX
+cp usr/bench/bench.bin $ROOTFS_SKEL/BIN/BENCH.ZEX
+cp usr/defrag/defrag.bin $ROOTFS_SKEL/BIN/DEFRAG.ZEX
 cp usr/zesh/zesh.bin $ROOTFS_SKEL/BIN/ZESH.ZEX
 (cd $ROOTFS_SKEL && rsync -av --exclude=".*" * $1)
 sync
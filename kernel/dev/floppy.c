@@ -9,6 +9,7 @@
 #include "floppy.h"
 #include "driver/floppy.h"
 #include "lib/errno.h"
+#include "lib/trace.h"
 
 #define SECTOR_SIZE 512
 
@@ -37,7 +38,10 @@ static uint16_t offs2lba(uint32_t offs)
 static int update_cache(uint16_t sector)
 {
 	if (cache.sno != sector) {
-		if (floppy_read_sector(sector, cache.sector) < 0) {
+		trace_event(TRACE_EV_BLK_READ, 0, sector);
+		int err = floppy_read_sector(sector, cache.sector);
+		trace_event(TRACE_EV_BLK_DONE, (err < 0) ? 1 : 0, sector);
+		if (err < 0) {
 			return -EIO;
 		}
 
@@ -93,10 +97,6 @@ static int blk_floppy_write(off_t offs, const void *buff, size_t bufflen)
 	size_t len = 0;
 	while (len < bufflen) {
 		uint16_t sector = offs2lba(offs);
-		if (update_cache(sector) < 0) {
-			return -EIO;
-		}
-
 		uint16_t pos = offs % SECTOR_SIZE;
 		uint16_t chunk = SECTOR_SIZE - pos;
 
@@ -104,12 +104,25 @@ static int blk_floppy_write(off_t offs, const void *buff, size_t bufflen)
 			chunk = bufflen - len;
 		}
 
+		if (chunk == SECTOR_SIZE) {
+			/* Whole sector is overwritten, no need to read it first */
+			cache.sno = sector;
+		}
+		else if (update_cache(sector) < 0) {
+			return -EIO;
+		}
+
 		memcpy(cache.sector + pos, (uint8_t *)buff + len, chunk);
 
 		len += chunk;
 		offs += chunk;
 
-		if (floppy_write_sector(sector, cache.sector) < 0) {
+		trace_event(TRACE_EV_BLK_WRITE, 0, sector);
+		int err = floppy_write_sector(sector, cache.sector);
+		trace_event(TRACE_EV_BLK_DONE, (err < 0) ? 1 : 0, sector);
+		if (err < 0) {
+			/* Cache no longer matches the disk */
+			cache.sno = 0xFFFF;
 			return -EIO;
 		}
 	}
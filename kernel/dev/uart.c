@@ -8,12 +8,19 @@
 #include <stddef.h>
 #include <stdarg.h>
 #include <sys/types.h>
+#include <sys/poll.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
 #include <z180/z180.h>
 #include "fs/devfs.h"
 #include "driver/critical.h"
 #include "hal/cpu.h"
 #include "lib/errno.h"
+#include "lib/trace.h"
+#include "lib/irqlat.h"
+#include "proc/timer.h"
 #include "proc/thread.h"
+#include "proc/poll.h"
 
 #define FIFO_SIZE 64
 
@@ -77,6 +84,9 @@ struct uart_ctx {
 	uint8_t minor;
 	struct thread *rxqueue;
 	struct thread *txqueue;
+	uint32_t rxstamp;
+	uint8_t rxwoken;
+	struct uart_mode mode;
 };
 
 static struct uart_ctx uartctx[2];
@@ -148,6 +158,8 @@ void dev_uart_irq_handler(uint8_t uart)
 {
 	uint8_t rx = 0, tx = 0;
 
+	_trace_event(TRACE_EV_IRQ, TRACE_IRQ_UART0 + uart, 0);
+
 	while (dev_uart_rxready(uart)) {
 		if (!_fifo_push(&uartctx[uart].rx, dev_uart_data_recv(uart), 1)) {
 			rx = 1;
@@ -167,31 +179,72 @@ void dev_uart_irq_handler(uint8_t uart)
 		}
 	}
 
-	if (rx)
+	if (rx || tx) {
+		_poll_notify();
+	}
+
+	if (rx && (uartctx[uart].rxqueue != NULL)) {
+		uartctx[uart].rxstamp = _timer_stamp();
+		uartctx[uart].rxwoken = 1;
 		_thread_signal_irq(&uartctx[uart].rxqueue);
+	}
 	if (tx)
 		_thread_signal_irq(&uartctx[uart].txqueue);
 }
 
-static int16_t dev_uart_read(uint8_t minor, void *buff, size_t bufflen, off_t offs)
+static int16_t dev_uart_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
 {
 	(void)offs;
 
 	uint8_t uart = dev_uart_minor_to_uart(minor);
-	size_t cnt;
+	struct uart_ctx *ctx = &uartctx[uart];
+	size_t want = (bufflen < ctx->mode.vmin) ? bufflen : ctx->mode.vmin;
+	size_t cnt = 0;
+	time_t deadline = 0;
+	uint8_t rearm = 1, expired = 0;
 
 	thread_critical_start();
-	for (cnt = 0; cnt < bufflen; ++cnt) {
-		while (fifo_pop(&uartctx[uart].rx, (uint8_t *)buff + cnt)) {
-			_thread_wait(&uartctx[uart].rxqueue, 0);
+	while (cnt < bufflen) {
+		if (!fifo_pop(&ctx->rx, (uint8_t *)buff + cnt)) {
+			++cnt;
+			rearm = 1;
+			continue;
+		}
+
+		/* Nothing more buffered */
+		if (((cnt >= want) && (cnt || !ctx->mode.vtime)) || expired || (flags & O_NONBLOCK)) {
+			break;
+		}
+
+		if (ctx->mode.vtime && (cnt || !ctx->mode.vmin)) {
+			/* Timed wait, interrupts cannot signal it directly - use poll queue */
+			if (rearm) {
+				deadline = timer_get() + ctx->mode.vtime;
+				rearm = 0;
+			}
+			if (_poll_wait(deadline) == -ETIME) {
+				expired = 1;
+			}
+		}
+		else {
+			_thread_wait(&ctx->rxqueue, 0);
+
+			if (ctx->rxwoken) {
+				ctx->rxwoken = 0;
+				irqlat_wakeup(ctx->rxstamp);
+			}
 		}
 	}
 	thread_critical_end();
 
+	if (!cnt && bufflen && (flags & O_NONBLOCK)) {
+		return -EAGAIN;
+	}
+
 	return cnt;
 }
 
-static int16_t dev_uart_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs)
+static int16_t dev_uart_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
 {
 	(void)offs;
 
@@ -199,17 +252,51 @@ static int16_t dev_uart_write(uint8_t minor, const void *buff, size_t bufflen, o
 	size_t cnt;
 
 	thread_critical_start();
-	for (cnt = 0; cnt < bufflen; ++cnt) {
-		while (fifo_push(&uartctx[uart].tx, ((const uint8_t *)buff)[cnt])) {
-			_thread_wait(&uartctx[uart].txqueue, 0);
+	cnt = 0;
+	while (cnt < bufflen) {
+		/* Fill the fifo as much as possible in one go */
+		critical_start();
+		while ((cnt < bufflen) && !_fifo_push(&uartctx[uart].tx, ((const uint8_t *)buff)[cnt], 0)) {
+			++cnt;
 		}
 		dev_uart_txirq_set(uart, 1);
+		critical_end();
+
+		if ((cnt < bufflen) && (flags & O_NONBLOCK)) {
+			break;
+		}
+
+		if (cnt < bufflen) {
+			_thread_wait(&uartctx[uart].txqueue, 0);
+		}
 	}
 	thread_critical_end();
 
+	if (!cnt && bufflen && (flags & O_NONBLOCK)) {
+		return -EAGAIN;
+	}
+
 	return cnt;
 }
 
+static uint8_t dev_uart_poll(uint8_t minor, uint8_t events)
+{
+	uint8_t uart = dev_uart_minor_to_uart(minor);
+	struct uart_ctx *ctx = &uartctx[uart];
+	uint8_t revents = 0;
+
+	critical_start();
+	if (ctx->rx.rd != ctx->rx.wr) {
+		revents |= POLLIN;
+	}
+	if (((ctx->tx.wr + 1) % sizeof(ctx->tx.buff)) != ctx->tx.rd) {
+		revents |= POLLOUT;
+	}
+	critical_end();
+
+	return revents & events;
+}
+
 static int8_t dev_uart_sync(uint8_t minor, off_t offs, off_t len)
 {
 	(void)minor;
@@ -220,11 +307,21 @@ static int8_t dev_uart_sync(uint8_t minor, off_t offs, off_t len)
 
 static int8_t dev_uart_ioctl(uint8_t minor, int16_t op, va_list arg)
 {
-	/* TODO */
-	(void)minor;
-	(void)op;
-	(void)arg;
-	return -ENOSYS;
+	struct uart_ctx *ctx = &uartctx[dev_uart_minor_to_uart(minor)];
+	struct uart_mode *mode = va_arg(arg, struct uart_mode *);
+
+	switch (op) {
+		case UART_IOC_GETMODE:
+			*mode = ctx->mode;
+			return 0;
+
+		case UART_IOC_SETMODE:
+			ctx->mode = *mode;
+			return 0;
+
+		default:
+			return -ENOSYS;
+	}
 }
 
 int8_t dev_uart_init(struct fs_ctx *devfs, uint8_t uart, uint16_t baud, uint8_t parity, uint8_t stop)
@@ -233,7 +330,8 @@ int8_t dev_uart_init(struct fs_ctx *devfs, uint8_t uart, uint16_t baud, uint8_t
 		.read = dev_uart_read,
 		.write = dev_uart_write,
 		.sync = dev_uart_sync,
-		.ioctl = dev_uart_ioctl
+		.ioctl = dev_uart_ioctl,
+		.poll = dev_uart_poll
 	};
 
 	/*
@@ -311,6 +409,8 @@ int8_t dev_uart_init(struct fs_ctx *devfs, uint8_t uart, uint16_t baud, uint8_t
 	}
 
 	uartctx[uart].minor = minor;
+	uartctx[uart].mode.vmin = 0xFFFF;
+	uartctx[uart].mode.vtime = 0;
 
 	return 0;
 }
@@ -0,0 +1,238 @@
+/* ZAK180 Firmaware
+ * Directory lookup cache
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fs/fs.h"
+#include "fs/dcache.h"
+#include "lib/errno.h"
+#include "lib/list.h"
+
+/* Remembers (directory, name) -> dentry of files that are not open,
+ * so a path walk does not rescan the directory. Entries of open
+ * files are left alone (lookup finds them in dir->children first)
+ * and refreshed from the fs_file when its last reference is dropped.
+ * Negative entries remember failed lookups, they are dropped when
+ * a file of that name is created.
+ *
+ * Directory nodes are freed as soon as nothing holds them, so a
+ * directory is keyed by its filesystem and first cluster instead,
+ * which stay the same until it is removed. Only FAT is cached. */
+
+#define DCACHE_SIZE     16
+#define DCACHE_BUCKETS  8
+#define DCACHE_NAME_MAX 12 /* 8.3 */
+
+struct dcache_entry {
+	/* NULL - unused */
+	struct fs_ctx *ctx;
+	uint16_t dir;
+
+	/* Hash bucket */
+	struct dcache_entry *hnext;
+
+	/* LRU, oldest first */
+	struct dcache_entry *lnext;
+	struct dcache_entry *lprev;
+
+	/* 0 - negative entry */
+	uint8_t attr;
+	off_t size;
+	union fs_file_internal internal;
+	char name[DCACHE_NAME_MAX + 1];
+};
+
+static struct {
+	struct dcache_entry entries[DCACHE_SIZE];
+	struct dcache_entry *hash[DCACHE_BUCKETS];
+	struct dcache_entry *lru;
+} common;
+
+static uint8_t dcache_namelen(const char *name)
+{
+	uint8_t len = 0;
+
+	while (name[len] != '/' && name[len] != '\0') {
+		if (++len > DCACHE_NAME_MAX) {
+			break;
+		}
+	}
+
+	return len;
+}
+
+/* 0 - directories of this filesystem are not cached */
+static uint8_t dcache_key(struct fs_file *dir, uint16_t *key)
+{
+	if (dir->ctx->type != FS_TYPE_FAT) {
+		return 0;
+	}
+
+	*key = dir->file.fat.cluster;
+
+	return 1;
+}
+
+static uint8_t dcache_hash(uint16_t dir, const char *name, uint8_t len)
+{
+	uint8_t h = dir;
+
+	for (uint8_t i = 0; i < len; ++i) {
+		h = (h << 1) + (h >> 7) + (uint8_t)name[i];
+	}
+
+	return h % DCACHE_BUCKETS;
+}
+
+static struct dcache_entry *dcache_find(struct fs_ctx *ctx, uint16_t dir, const char *name, uint8_t len, uint8_t bucket)
+{
+	for (struct dcache_entry *e = common.hash[bucket]; e != NULL; e = e->hnext) {
+		if ((e->ctx == ctx) && (e->dir == dir) && !strncmp(e->name, name, len) && (e->name[len] == '\0')) {
+			return e;
+		}
+	}
+
+	return NULL;
+}
+
+static void dcache_touch(struct dcache_entry *e)
+{
+	LIST_REMOVE(&common.lru, e, struct dcache_entry, lnext, lprev);
+	LIST_ADD(&common.lru, e, struct dcache_entry, lnext, lprev);
+}
+
+static void dcache_drop(struct dcache_entry *e)
+{
+	uint8_t bucket = dcache_hash(e->dir, e->name, strlen(e->name));
+	struct dcache_entry **p = &common.hash[bucket];
+
+	while (*p != e) {
+		p = &(*p)->hnext;
+	}
+	*p = e->hnext;
+
+	e->ctx = NULL;
+	e->hnext = NULL;
+
+	/* Reuse it first */
+	dcache_touch(e);
+	common.lru = e;
+}
+
+int8_t dcache_lookup(struct fs_file *dir, const char *name, struct fs_dentry *dentry, union fs_file_internal *internal)
+{
+	uint16_t key;
+	uint8_t len = dcache_namelen(name);
+	if ((len > DCACHE_NAME_MAX) || !dcache_key(dir, &key)) {
+		return -EAGAIN;
+	}
+
+	struct dcache_entry *e = dcache_find(dir->ctx, key, name, len, dcache_hash(key, name, len));
+	if (e == NULL) {
+		return -EAGAIN;
+	}
+
+	dcache_touch(e);
+
+	if (!e->attr) {
+		return -ENOENT;
+	}
+
+	memset(dentry, 0, sizeof(*dentry));
+	strcpy(dentry->name, e->name);
+	dentry->attr = e->attr;
+	dentry->size = e->size;
+	memcpy(internal, &e->internal, sizeof(*internal));
+
+	return 0;
+}
+
+static struct dcache_entry *dcache_get(struct fs_file *dir, const char *name)
+{
+	uint16_t key;
+	uint8_t len = dcache_namelen(name);
+	if ((len > DCACHE_NAME_MAX) || !dcache_key(dir, &key)) {
+		return NULL;
+	}
+
+	uint8_t bucket = dcache_hash(key, name, len);
+	struct dcache_entry *e = dcache_find(dir->ctx, key, name, len, bucket);
+
+	if (e == NULL) {
+		/* Evict the least recently used one */
+		e = common.lru;
+		if (e->ctx != NULL) {
+			dcache_drop(e);
+		}
+
+		e->ctx = dir->ctx;
+		e->dir = key;
+		memcpy(e->name, name, len);
+		e->name[len] = '\0';
+		e->hnext = common.hash[bucket];
+		common.hash[bucket] = e;
+	}
+
+	dcache_touch(e);
+
+	return e;
+}
+
+void dcache_insert(struct fs_file *dir, const char *name, uint8_t attr, off_t size, const union fs_file_internal *internal)
+{
+	struct dcache_entry *e = dcache_get(dir, name);
+	if (e != NULL) {
+		e->attr = attr;
+		e->size = size;
+		memcpy(&e->internal, internal, sizeof(e->internal));
+	}
+}
+
+void dcache_insert_negative(struct fs_file *dir, const char *name)
+{
+	struct dcache_entry *e = dcache_get(dir, name);
+	if (e != NULL) {
+		e->attr = 0;
+		e->size = 0;
+	}
+}
+
+void dcache_invalidate(struct fs_file *dir, const char *name)
+{
+	uint16_t key;
+	uint8_t len = dcache_namelen(name);
+	if ((len > DCACHE_NAME_MAX) || !dcache_key(dir, &key)) {
+		return;
+	}
+
+	struct dcache_entry *e = dcache_find(dir->ctx, key, name, len, dcache_hash(key, name, len));
+	if (e != NULL) {
+		dcache_drop(e);
+	}
+}
+
+void dcache_purge(struct fs_file *dir)
+{
+	uint16_t key;
+	if (!dcache_key(dir, &key)) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < DCACHE_SIZE; ++i) {
+		if ((common.entries[i].ctx == dir->ctx) && (common.entries[i].dir == key)) {
+			dcache_drop(&common.entries[i]);
+		}
+	}
+}
+
+void dcache_init(void)
+{
+	for (uint8_t i = 0; i < DCACHE_SIZE; ++i) {
+		LIST_ADD(&common.lru, &common.entries[i], struct dcache_entry, lnext, lprev);
+	}
+}
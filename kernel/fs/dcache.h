@@ -0,0 +1,37 @@
+/* ZAK180 Firmaware
+ * Directory lookup cache
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef FS_DCACHE_H_
+#define FS_DCACHE_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+struct fs_file;
+struct fs_dentry;
+union fs_file_internal;
+
+/* All calls are made with the fs lock held.
+ * name is a path component, terminated with '/' or '\0'. */
+
+/* 0 - hit (dentry name, attr and size are filled),
+ * -ENOENT - known to be missing, -EAGAIN - unknown */
+int8_t dcache_lookup(struct fs_file *dir, const char *name, struct fs_dentry *dentry, union fs_file_internal *internal);
+
+/* Adds or refreshes the entry of the file */
+void dcache_insert(struct fs_file *dir, const char *name, uint8_t attr, off_t size, const union fs_file_internal *internal);
+
+/* Name is not in the directory */
+void dcache_insert_negative(struct fs_file *dir, const char *name);
+
+void dcache_invalidate(struct fs_file *dir, const char *name);
+
+/* Drops all entries of the directory, its first cluster is going to be reused */
+void dcache_purge(struct fs_file *dir);
+
+void dcache_init(void);
+
+#endif
@@ -25,14 +25,15 @@ struct devfs_entry {
 	char name[];
 };
 
-static int16_t devfs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs);
-static int16_t devfs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs);
+static int16_t devfs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
+static int16_t devfs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
 static int8_t devfs_create(struct fs_file *dir, const char *name, uint8_t attr, uint16_t *idx);
 static int8_t devfs_truncate(struct fs_file *file, uint32_t size);
 static int8_t devfs_readdir(struct fs_file *dir, struct fs_dentry *dentry, union fs_file_internal *file, uint16_t idx);
 static int8_t devfs_move(struct fs_file *file, struct fs_file *ndir, const char *name);
 static int8_t devfs_remove(struct fs_file *file);
-static int8_t devfs_ioctl(struct fs_file *file, int16_t op, va_list arg);
+static int8_t devfs_ioctl(struct fs_file *file, int16_t op, uint8_t flags, va_list arg);
+static uint8_t devfs_poll(struct fs_file *file, uint8_t events);
 static int8_t devfs_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_file *root);
 static int8_t devfs_unmount(struct fs_ctx *ctx);
 
@@ -42,29 +43,36 @@ const struct fs_file_op devfs_ops = {
 	.create = devfs_create,
 	.truncate = devfs_truncate,
 	.readdir = devfs_readdir,
+	.getdents = NULL,
+	.statfs = NULL,
+	.fsync = NULL,
+	.fallocate = NULL,
+	.sync = NULL,
 	.move = devfs_move,
 	.remove = devfs_remove,
 	.ioctl = devfs_ioctl,
+	.poll = devfs_poll,
 	.mount = devfs_mount,
-	.unmount = devfs_unmount
+	.unmount = devfs_unmount,
+	.release = NULL
 };
 
-static int16_t devfs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs)
+static int16_t devfs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
 {
 	if (file->file.devfs.entry == NULL) {
 		return -ENOSYS;
 	}
 
-	return file->file.devfs.entry->ops->read(file->file.devfs.entry->minor, buff, bufflen, offs);
+	return file->file.devfs.entry->ops->read(file->file.devfs.entry->minor, buff, bufflen, offs, flags);
 }
 
-static int16_t devfs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs)
+static int16_t devfs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
 {
 	if (file->file.devfs.entry == NULL) {
 		return -ENOSYS;
 	}
 
-	return file->file.devfs.entry->ops->write(file->file.devfs.entry->minor, buff, bufflen, offs);
+	return file->file.devfs.entry->ops->write(file->file.devfs.entry->minor, buff, bufflen, offs, flags);
 }
 
 static int8_t devfs_create(struct fs_file *dir, const char *name, uint8_t attr, uint16_t *idx)
@@ -139,8 +147,10 @@ static int8_t devfs_remove(struct fs_file *file)
 	return -ENOSYS;
 }
 
-static int8_t devfs_ioctl(struct fs_file *file, int16_t op, va_list arg)
+static int8_t devfs_ioctl(struct fs_file *file, int16_t op, uint8_t flags, va_list arg)
 {
+	(void)flags;
+
 	if (file->file.devfs.entry->ops->ioctl == NULL) {
 		return -ENOSYS;
 	}
@@ -148,6 +158,15 @@ static int8_t devfs_ioctl(struct fs_file *file, int16_t op, va_list arg)
 	return file->file.devfs.entry->ops->ioctl(file->file.devfs.entry->minor, op, arg);
 }
 
+static uint8_t devfs_poll(struct fs_file *file, uint8_t events)
+{
+	if ((file->file.devfs.entry == NULL) || (file->file.devfs.entry->ops->poll == NULL)) {
+		return events;
+	}
+
+	return file->file.devfs.entry->ops->poll(file->file.devfs.entry->minor, events);
+}
+
 static int8_t devfs_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_file *root)
 {
 	ctx->devfs.entries = NULL;
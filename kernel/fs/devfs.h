@@ -19,10 +19,16 @@ struct fs_file_op;
 struct fs_file;
 
 struct dev_ops {
-	int16_t (*read)(uint8_t minor, void *buff, size_t bufflen, off_t offs);
-	int16_t (*write)(uint8_t minor, const void *buff, size_t bufflen, off_t offs);
+	/* flags - O_NONBLOCK of the open file */
+	int16_t (*read)(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags);
+	int16_t (*write)(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags);
 	int8_t (*sync)(uint8_t minor, off_t offs, off_t len);
 	int8_t (*ioctl)(uint8_t minor, int16_t op, va_list arg);
+
+	/* Returns ready subset of POLL* events, must not block.
+	 * NULL - always ready. Readiness changes are reported
+	 * with poll_notify(). */
+	uint8_t (*poll)(uint8_t minor, uint8_t events);
 };
 
 struct devfs_entry;
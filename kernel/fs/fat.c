@@ -8,6 +8,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <fcntl.h>
+#include <sys/ioctl.h>
 
 #include "fs/fat.h"
 #include "fs/fs.h"
@@ -21,21 +22,39 @@
 #define FAT12_ROOT_SIZE   14
 #define FAT12_DATA_START  (1 + (FAT12_FAT_COPIES * FAT12_FAT_SIZE) + FAT12_ROOT_SIZE)
 
+/* 1.44 MB floppy - 2 heads x 18 sectors */
+#define FAT12_CYL_SECTORS 36
+
 #define CLUSTER2SECTOR(c) ((c) + FAT12_DATA_START - 2)
 #define SECTOR2CLUSTER(s) ((x) + 2 - FAT12_DATA_START)
 
+/* FAT is kept decoded, one uint16_t per entry in two pages.
+ * FAT sectors 0-5 hold entries of page 0, 6-8 of page 1,
+ * no FAT sector spans both pages. */
+#define FAT_PAGE_ENTRIES (PAGE_SIZE / sizeof(uint16_t))
+
+/* Free clusters bitmap (bit set - in use) lives in the unused
+ * upper half of the second FAT page */
+#define FAT_BITMAP_OFFS (PAGE_SIZE / 2)
+
 #define CLUSTER_FREE     0
 #define CLUSTER_RESERVED 0xFF0
 #define CLUSTER_END      0xFFF
 
 static int8_t fat_op_create(struct fs_file *dir, const char *name, uint8_t attr, uint16_t *idx);
-static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs);
+static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
 static int8_t fat_op_truncate(struct fs_file *file, uint32_t size);
-static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs);
+static int8_t fat_op_fsync(struct fs_file *file);
+static int8_t fat_op_fallocate(struct fs_file *file, uint32_t len);
+static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
 static int8_t fat_op_readdir(struct fs_file *dir, struct fs_dentry *dentry, union fs_file_internal *file, uint16_t idx);
+static int16_t fat_op_getdents(struct fs_file *dir, struct fs_dentry *dentries, uint8_t count, uint16_t *idx);
 static int8_t fat_op_move(struct fs_file *file, struct fs_file *ndir, const char *name);
+static int8_t fat_op_ioctl(struct fs_file *file, int16_t op, uint8_t flags, va_list arg);
+static int8_t fat_op_statfs(struct fs_file *file, struct statfs *buf);
 static int8_t fat_op_remove(struct fs_file *file);
 static int8_t fat_op_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_file *root);
+static int8_t fat_op_sync(struct fs_ctx *ctx);
 static int8_t fat_op_unmount(struct fs_ctx *ctx);
 
 const struct fs_file_op fat_op = {
@@ -44,11 +63,18 @@ const struct fs_file_op fat_op = {
 	.write = fat_op_write,
 	.truncate = fat_op_truncate,
 	.readdir = fat_op_readdir,
+	.getdents = fat_op_getdents,
 	.move = fat_op_move,
 	.remove = fat_op_remove,
-	.ioctl = NULL,
+	.ioctl = fat_op_ioctl,
+	.poll = NULL, /* Always ready */
+	.statfs = fat_op_statfs,
+	.fsync = fat_op_fsync,
+	.fallocate = fat_op_fallocate,
+	.sync = fat_op_sync,
 	.mount = fat_op_mount,
-	.unmount = fat_op_unmount
+	.unmount = fat_op_unmount,
+	.release = NULL
 };
 
 static uint16_t fat_sector_round_down(off_t offs)
@@ -66,35 +92,21 @@ static off_t fat_sector_offset(uint16_t sector)
 	return (off_t)sector * FAT12_SECTOR_SIZE;
 }
 
+/* No file is larger than the whole data area */
+static uint32_t fat_size_max(struct fs_ctx *ctx)
+{
+	return (uint32_t)(fat_sector_round_down(ctx->cb->size) - FAT12_DATA_START) * FAT12_SECTOR_SIZE;
+}
+
 static int8_t fat_fat_get(struct fs_ctx *ctx, uint16_t n, uint16_t *cluster)
 {
 	if (CLUSTER2SECTOR(n) >= fat_sector_round_down(ctx->cb->size)) {
 		return -EIO;
 	}
 
-	uint16_t idx = (3 * n) / 2;
-	uint8_t page = (idx < PAGE_SIZE) ? 0 : 1;
-	idx %= PAGE_SIZE;
 	uint8_t page_prev;
-	const uint8_t *fat = mmu_map_scratch(ctx->fat.fat_page[page], &page_prev);
-
-	*cluster = fat[idx];
-	if (n & 1) {
-		*cluster >>= 4;
-	}
-
-	if (++idx == PAGE_SIZE) {
-		fat = mmu_map_scratch(ctx->fat.fat_page[1], NULL);
-		idx = 0;
-	}
-
-	if (n & 1) {
-		*cluster |= (uint16_t)fat[idx] << 4;
-	}
-	else {
-		*cluster |= (uint16_t)(fat[idx] & 0x0F) << 8;
-	}
-
+	const uint16_t *fat = mmu_map_scratch(ctx->fat.fat_page[n / FAT_PAGE_ENTRIES], &page_prev);
+	*cluster = fat[n % FAT_PAGE_ENTRIES];
 	(void)mmu_map_scratch(page_prev, NULL);
 
 	if (*cluster >= 0xFF8) {
@@ -113,92 +125,185 @@ static int8_t fat_fat_set(struct fs_ctx *ctx, uint16_t n, uint16_t cluster)
 		return -1;
 	}
 
-	uint16_t idx = (3 * n) / 2;
-	uint8_t page = (idx > PAGE_SIZE) ? 1 : 0;
-	idx %= PAGE_SIZE;
 	uint8_t page_prev;
-	uint8_t *fat = mmu_map_scratch(ctx->fat.fat_page[page], &page_prev);
-	uint16_t buff = cluster;
-
-	if (n & 1) {
-		buff = (buff << 4) | (fat[idx] & 0x0F);
-	}
-
-	fat[idx] = buff & 0xFF;
-	ctx->fat.fat_dirty |= (1 << ((page << 3) + (idx >> 9)));
-
-	if (++idx == PAGE_SIZE) {
-		fat = mmu_map_scratch(ctx->fat.fat_page[1], NULL);
-		idx = 0;
-		ctx->fat.fat_dirty |= (1 << 8);
+	uint16_t *fat = mmu_map_scratch(ctx->fat.fat_page[n / FAT_PAGE_ENTRIES], &page_prev);
+	fat[n % FAT_PAGE_ENTRIES] = cluster;
+
+	/* Allocated clusters are marked already by fat_fat_allocate_cluster() */
+	uint8_t *bitmap = (uint8_t *)mmu_map_scratch(ctx->fat.fat_page[1], NULL) + FAT_BITMAP_OFFS;
+	uint8_t mask = 1 << (n & 7);
+	if (cluster == CLUSTER_FREE) {
+		if (bitmap[n >> 3] & mask) {
+			bitmap[n >> 3] &= ~mask;
+			++ctx->fat.free;
+		}
 	}
-
-	if (!(n & 1)) {
-		buff |= (uint16_t)(fat[idx] & 0xF0) << 8;
+	else if (!(bitmap[n >> 3] & mask)) {
+		bitmap[n >> 3] |= mask;
+		--ctx->fat.free;
 	}
 
-	fat[idx] = buff >> 8;
 	(void)mmu_map_scratch(page_prev, NULL);
 
-	idx = (3 * n) / 2;
+	/* Packed entry takes 1.5 byte, it might span two sectors */
+	uint16_t idx = (3 * n) / 2;
+	ctx->fat.fat_dirty |= (1u << (idx / FAT12_SECTOR_SIZE)) | (1u << ((idx + 1) / FAT12_SECTOR_SIZE));
 
 	return 0;
 }
 
-static int8_t fat_fat_sync(struct fs_ctx *ctx)
+/* Byte b of the packed FAT belongs to the entry pair 2 * (b / 3):
+ * b % 3 == 0 - low 8 bits of the even entry,
+ * b % 3 == 1 - high 4 bits of the even, low 4 bits of the odd one,
+ * b % 3 == 2 - high 8 bits of the odd entry. */
+
+static void fat_fat_pack(struct fs_ctx *ctx, uint8_t sector, uint8_t *buff)
 {
+	uint16_t b = fat_sector_offset(sector);
+	uint8_t page = ((b / 3) * 2) / FAT_PAGE_ENTRIES;
 	uint8_t page_prev;
-	uint8_t *fat = mmu_map_scratch(ctx->fat.fat_page[0], &page_prev);
-	int ret = 0;
+	const uint16_t *fat = mmu_map_scratch(ctx->fat.fat_page[page], &page_prev);
 
-	for (uint8_t i = 0; i < FAT12_FAT_SIZE; ++i) {
-		if (!ctx->fat.fat_dirty) {
-			break;
+	uint16_t n = ((b / 3) * 2) % FAT_PAGE_ENTRIES;
+	uint8_t r = b % 3;
+
+	for (uint16_t i = 0; i < FAT12_SECTOR_SIZE; ++i) {
+		switch (r) {
+			case 0:
+				buff[i] = fat[n];
+				break;
+
+			case 1:
+				buff[i] = ((fat[n] >> 8) & 0x0F) | (fat[n + 1] << 4);
+				break;
+
+			default:
+				buff[i] = fat[n + 1] >> 4;
+				break;
 		}
 
-		if (i == fat_sector_round_down(PAGE_SIZE)) {
-			mmu_map_scratch(ctx->fat.fat_page[1], NULL);
+		if (++r == 3) {
+			r = 0;
+			n += 2;
 		}
+	}
 
-		if (ctx->fat.fat_dirty & (1u << i)) {
-			uint16_t offset = fat_sector_offset(i % (PAGE_SIZE / FAT12_SECTOR_SIZE));
-			ret = ctx->cb->write(fat_sector_offset(i + 1), fat + offset, FAT12_SECTOR_SIZE);
-			if (ret < 0) {
+	(void)mmu_map_scratch(page_prev, NULL);
+}
+
+static void fat_fat_unpack(struct fs_ctx *ctx, uint8_t sector, const uint8_t *buff)
+{
+	uint16_t b = fat_sector_offset(sector);
+	uint8_t page = ((b / 3) * 2) / FAT_PAGE_ENTRIES;
+	uint8_t page_prev;
+	uint16_t *fat = mmu_map_scratch(ctx->fat.fat_page[page], &page_prev);
+
+	/* Sectors are unpacked in order, so the part of an entry
+	 * from the previous sector is already there */
+	uint16_t n = ((b / 3) * 2) % FAT_PAGE_ENTRIES;
+	uint8_t r = b % 3;
+
+	for (uint16_t i = 0; i < FAT12_SECTOR_SIZE; ++i) {
+		switch (r) {
+			case 0:
+				fat[n] = buff[i];
 				break;
-			}
 
-			ret = ctx->cb->write(fat_sector_offset(i + FAT12_FAT_SIZE + 1), fat + offset, FAT12_SECTOR_SIZE);
-			if (ret < 0) {
+			case 1:
+				fat[n] |= (uint16_t)(buff[i] & 0x0F) << 8;
+				fat[n + 1] = buff[i] >> 4;
 				break;
-			}
+
+			default:
+				fat[n + 1] |= (uint16_t)buff[i] << 4;
+				break;
+		}
+
+		if (++r == 3) {
+			r = 0;
+			n += 2;
 		}
 	}
 
 	(void)mmu_map_scratch(page_prev, NULL);
+}
 
-	if (ret < 0) {
-		return ret;
-	}
+/* Packed form is regenerated only for the dirty sectors. They are
+ * written in ascending order, all of the primary copy first, then
+ * the mirror - a crash in the middle leaves one of the copies
+ * consistent (old or new). Caller holds the FAT lock. */
+static int8_t fat_fat_sync(struct fs_ctx *ctx)
+{
+	/* Make sure this is on stack, we cannot afford to waste that much of static memory */
+	uint8_t packed[FAT12_SECTOR_SIZE];
+	uint16_t dirty = ctx->fat.fat_dirty;
 
 	ctx->fat.fat_dirty = 0;
+
+	for (uint8_t copy = 0; copy < FAT12_FAT_COPIES; ++copy) {
+		for (uint8_t i = 0; i < FAT12_FAT_SIZE; ++i) {
+			if (!(dirty & (1u << i))) {
+				continue;
+			}
+
+			fat_fat_pack(ctx, i, packed);
+
+			int ret = ctx->cb->write(fat_sector_offset(1 + (copy * FAT12_FAT_SIZE) + i), packed, FAT12_SECTOR_SIZE);
+			if (ret < 0) {
+				ctx->fat.fat_dirty |= dirty;
+				return ret;
+			}
+		}
+	}
+
 	return 0;
 }
 
-static int8_t fat_fat_fetch(struct fs_ctx *ctx)
+/* Clusters 0, 1 and past the end of the disk are marked as used */
+static void fat_bitmap_build(struct fs_ctx *ctx)
 {
 	uint8_t page_prev;
-	void *fat_buff = mmu_map_scratch(ctx->fat.fat_page[0], &page_prev);
-	int err = ctx->cb->read(FAT12_SECTOR_SIZE, fat_buff, PAGE_SIZE);
-	if (err != PAGE_SIZE) {
-		(void)mmu_map_scratch(page_prev, NULL);
-		return -EIO;
+	(void)mmu_map_scratch(ctx->fat.fat_page[0], &page_prev);
+
+	ctx->fat.free = 0;
+
+	for (uint16_t i = 0; i < (ctx->fat.end + 7) / 8; ++i) {
+		/* FAT_PAGE_ENTRIES is a multiple of 8 */
+		const uint16_t *fat = mmu_map_scratch(ctx->fat.fat_page[(i * 8) / FAT_PAGE_ENTRIES], NULL);
+		uint8_t bits = 0;
+
+		for (uint8_t j = 0; j < 8; ++j) {
+			uint16_t n = (i * 8) + j;
+			if ((n < 2) || (n >= ctx->fat.end) || (fat[n % FAT_PAGE_ENTRIES] != CLUSTER_FREE)) {
+				bits |= 1 << j;
+			}
+			else {
+				++ctx->fat.free;
+			}
+		}
+
+		uint8_t *bitmap = (uint8_t *)mmu_map_scratch(ctx->fat.fat_page[1], NULL) + FAT_BITMAP_OFFS;
+		bitmap[i] = bits;
 	}
-	fat_buff = mmu_map_scratch(ctx->fat.fat_page[1], NULL);
-	err = ctx->cb->read(FAT12_SECTOR_SIZE + PAGE_SIZE, fat_buff, FAT12_SECTOR_SIZE * FAT12_FAT_SIZE - PAGE_SIZE);
+
 	(void)mmu_map_scratch(page_prev, NULL);
-	if (err != (FAT12_SECTOR_SIZE * FAT12_FAT_SIZE - PAGE_SIZE)) {
-		return -EIO;
+}
+
+static int8_t fat_fat_fetch(struct fs_ctx *ctx)
+{
+	uint8_t packed[FAT12_SECTOR_SIZE];
+
+	for (uint8_t i = 0; i < FAT12_FAT_SIZE; ++i) {
+		int err = ctx->cb->read(fat_sector_offset(i + 1), packed, FAT12_SECTOR_SIZE);
+		if (err != FAT12_SECTOR_SIZE) {
+			return -EIO;
+		}
+
+		fat_fat_unpack(ctx, i, packed);
 	}
+
+	fat_bitmap_build(ctx);
+
 	ctx->fat.fat_dirty = 0;
 	return 0;
 }
@@ -235,32 +340,139 @@ static int8_t fat_fat_seek(struct fs_ctx *ctx, struct fat_file *file, uint16_t *
 	return 0;
 }
 
-static int8_t fat_fat_allocate_cluster(struct fs_ctx *ctx, uint16_t start, uint16_t *new)
+/* Like fat_fat_seek, but starts from the file's chain cursor when
+ * possible and leaves it at the result. Caller holds the file lock. */
+static int8_t fat_file_seek(struct fs_ctx *ctx, struct fat_file *file, uint16_t *cluster, uint32_t offs)
+{
+	uint16_t target = offs / FAT12_SECTOR_SIZE;
+	uint16_t pos = 0;
+
+	*cluster = file->cluster;
+
+	if (file->curr && (file->pos <= target)) {
+		*cluster = file->curr;
+		pos = file->pos;
+	}
+
+	for (; pos < target; ++pos) {
+		int8_t ret = fat_fat_next(ctx, cluster);
+		if (ret != 0) {
+			return ret;
+		}
+	}
+
+	file->curr = *cluster;
+	file->pos = target;
+
+	return 0;
+}
+
+static void fat_file_cursor_set(struct fat_file *file, uint16_t cluster, uint32_t offs)
+{
+	file->curr = cluster;
+	file->pos = offs / FAT12_SECTOR_SIZE;
+}
+
+/* First free cluster at or after from, wrapping around, 0 if none */
+static uint16_t fat_bitmap_find(const uint8_t *bitmap, uint16_t end, uint16_t from)
 {
-	uint8_t retry = 0;
+	uint16_t bytes = (end + 7) / 8;
+	uint16_t idx = (from < end) ? (from / 8) : 0;
 
-	for (*new = start + 1; ; ++(*new)) {
-		uint16_t ncluster;
-		if (*new == start) {
-			/* No space */
-			return -ENOSPC;
+	for (uint16_t i = 0; i <= bytes; ++i, ++idx) {
+		if (idx >= bytes) {
+			idx = 0;
 		}
 
-		if (fat_fat_get(ctx, *new, &ncluster) < 0) {
-			if (retry) {
-				/* Fail caused by something other than running out of clusters */
-				return -EIO;
+		uint8_t bits = bitmap[idx];
+		if (bits == 0xFF) {
+			continue;
+		}
+
+		for (uint8_t j = 0; j < 8; ++j) {
+			if (!(bits & (1 << j))) {
+				return (idx * 8) + j;
 			}
-			/* Try from the FAT start instead */
-			retry = 1;
-			*new = 0;
 		}
+	}
 
-		if (ncluster == CLUSTER_FREE) {
-			break;
+	return 0;
+}
+
+/* First run of count free clusters at or after from (wraps around),
+ * 0 if there is none */
+static uint16_t fat_bitmap_find_run(const uint8_t *bitmap, uint16_t end, uint16_t from, uint16_t count)
+{
+	uint16_t n = ((from >= 2) && (from < end)) ? from : 2;
+	uint16_t run = 0;
+
+	for (uint16_t i = 2; i < end; ++i, ++n) {
+		if (n >= end) {
+			/* Runs do not wrap */
+			n = 2;
+			run = 0;
 		}
+
+		if (bitmap[n >> 3] & (1 << (n & 7))) {
+			run = 0;
+		}
+		else if (++run == count) {
+			return n - count + 1;
+		}
+	}
+
+	return 0;
+}
+
+/* from - 0 to search from the allocation hint */
+static uint16_t fat_fat_find_run(struct fs_ctx *ctx, uint16_t from, uint16_t count)
+{
+	if (count > ctx->fat.free) {
+		return 0;
+	}
+
+	uint8_t page_prev;
+	const uint8_t *bitmap = (const uint8_t *)mmu_map_scratch(ctx->fat.fat_page[1], &page_prev) + FAT_BITMAP_OFFS;
+	uint16_t n = fat_bitmap_find_run(bitmap, ctx->fat.end, from ? from : ctx->fat.hint, count);
+	(void)mmu_map_scratch(page_prev, NULL);
+
+	return n;
+}
+
+/* The cluster is marked as used right away, so subsequent calls
+ * (before it is linked in the FAT) do not return it again. start is
+ * the current last cluster of the file, the one right after it is
+ * preferred to keep the file contiguous. Otherwise the search starts
+ * at the hint, which follows the previous allocation. */
+static int8_t fat_fat_allocate_cluster(struct fs_ctx *ctx, uint16_t start, uint16_t *new)
+{
+	if (!ctx->fat.free) {
+		return -ENOSPC;
 	}
 
+	uint8_t page_prev;
+	uint8_t *bitmap = (uint8_t *)mmu_map_scratch(ctx->fat.fat_page[1], &page_prev) + FAT_BITMAP_OFFS;
+	uint16_t n = start + 1;
+
+	if ((n < 2) || (n >= ctx->fat.end) || (bitmap[n >> 3] & (1 << (n & 7)))) {
+		n = fat_bitmap_find(bitmap, ctx->fat.end, ctx->fat.hint);
+	}
+
+	if (n) {
+		bitmap[n >> 3] |= 1 << (n & 7);
+		--ctx->fat.free;
+		ctx->fat.hint = n + 1;
+	}
+
+	(void)mmu_map_scratch(page_prev, NULL);
+
+	if (!n) {
+		/* Free count says otherwise */
+		return -EIO;
+	}
+
+	*new = n;
+
 	return 0;
 }
 
@@ -272,6 +484,9 @@ static int8_t fat_file_dir_access(struct fs_ctx *ctx, struct fat_file *dir, uint
 
 	/* Root dir has to be processed separatelly, as it has negative cluster index */
 	if (dir->cluster == 0xffff) {
+		if (offs >= fat_sector_offset(FAT12_ROOT_SIZE)) {
+			return -ENOENT;
+		}
 		*sector = 1 + (FAT12_FAT_COPIES * FAT12_FAT_SIZE) + fat_sector_round_down(offs);
 	}
 	else {
@@ -374,7 +589,45 @@ static int8_t fat_cluster_clear(struct fs_ctx *ctx, uint16_t cluster, size_t off
 	return ctx->cb->write(fat_sector_offset(CLUSTER2SECTOR(cluster)) + offs, zeroes, len) == len ? 0 : -EIO;
 }
 
-static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentry, uint16_t length)
+/* Zero-fills [from, to) of the file, chain has to cover it */
+static int8_t fat_file_zero(struct fs_file *file, uint32_t from, uint32_t to)
+{
+	uint16_t cluster;
+
+	if (from >= to) {
+		return 0;
+	}
+
+	if (fat_file_seek(file->ctx, &file->file.fat, &cluster, from) != 0) {
+		return -EIO;
+	}
+
+	while (1) {
+		uint16_t mod = from % FAT12_SECTOR_SIZE;
+		uint16_t len = FAT12_SECTOR_SIZE - mod;
+		if (len > to - from) {
+			len = to - from;
+		}
+
+		if (fat_cluster_clear(file->ctx, cluster, mod, len) < 0) {
+			return -EIO;
+		}
+
+		from += len;
+		if (from >= to) {
+			break;
+		}
+
+		if (fat_fat_next(file->ctx, &cluster) != 0) {
+			return -EIO;
+		}
+	}
+
+	return 0;
+}
+
+/* clear - zero-fill newly allocated clusters */
+static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentry, uint16_t length, uint8_t clear)
 {
 	uint16_t start = file->file.fat.cluster;
 	uint16_t curr = start, last = start;
@@ -385,6 +638,9 @@ static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentr
 		return 0;
 	}
 
+	/* Chain changes, forget the cursor */
+	file->file.fat.curr = 0;
+
 	if (start) {
 		for (pos = 1; pos <= length; ++pos) {
 			curr = last;
@@ -407,13 +663,28 @@ static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentr
 	}
 
 	if (pos < length) {
+		/* Place all the new clusters in one contiguous run if there
+		 * is one, they are allocated one after another from there */
+		uint16_t prev = last;
+		if (length - pos > 1) {
+			uint16_t run = fat_fat_find_run(file->ctx, (last >= 2) ? (last + 1) : 0, length - pos);
+			if (run) {
+				prev = run - 1;
+			}
+		}
+
 		for (; pos < length; ++pos) {
-			err = fat_fat_allocate_cluster(file->ctx, last, &curr);
+			err = fat_fat_allocate_cluster(file->ctx, prev, &curr);
 			if (err < 0) {
+				if (file->file.fat.cluster) {
+					/* Keep the chain walkable for the rollback */
+					(void)fat_fat_set(file->ctx, last, CLUSTER_END);
+				}
 				return err;
 			}
+			prev = curr;
 
-			if (!dentry->cluster) {
+			if (!file->file.fat.cluster) {
 				if (dentry != NULL) {
 					dentry->cluster = curr;
 				}
@@ -425,7 +696,7 @@ static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentr
 				}
 			}
 
-			if (fat_cluster_clear(file->ctx, curr, 0, FAT12_SECTOR_SIZE) < 0) {
+			if (clear && (fat_cluster_clear(file->ctx, curr, 0, FAT12_SECTOR_SIZE) < 0)) {
 				return -EIO;
 			}
 
@@ -474,7 +745,8 @@ static int8_t fat_file_trim_chain(struct fs_file *file, struct fat_dentry *dentr
 		}
 	}
 
-	return fat_fat_sync(file->ctx);
+	/* FAT is flushed by the caller */
+	return 0;
 }
 
 static int8_t fat_op_create(struct fs_file *dir, const char *name, uint8_t attr, uint16_t *idx)
@@ -519,29 +791,35 @@ static int8_t fat_op_create(struct fs_file *dir, const char *name, uint8_t attr,
 
 	/* TODO times */
 
+	lock_lock(&dir->ctx->fat.lock);
+
 	/* Find removed or free entry */
 	uint16_t fidx;
+	int8_t err;
 	for (fidx = 0;; ++fidx) {
 		struct fat_dentry tentry;
-		int8_t err = fat_file_dir_read(dir->ctx, &dir->file.fat, &tentry, fidx);
+		err = fat_file_dir_read(dir->ctx, &dir->file.fat, &tentry, fidx);
 		if (err == -ENOENT) {
 			/* We've run out of dir clusters, extend it */
 
 			if (dir->file.fat.cluster == 0xFFFF) {
 				/* Rootdir, it cannot be extended */
-				return -ENOSPC;
+				err = -ENOSPC;
+				break;
 			}
 
-			err = fat_file_trim_chain(dir, NULL, fat_sector_round_up((fidx + 1) * sizeof(struct fat_dentry)));
-			if (err < 0) {
-				return err;
+			err = fat_file_trim_chain(dir, NULL, fat_sector_round_up((fidx + 1) * sizeof(struct fat_dentry)), 1);
+			if (err == 0) {
+				/* The new entry lives in the new cluster */
+				err = fat_fat_sync(dir->ctx);
+			}
+			if (err == 0) {
+				err = fat_file_dir_read(dir->ctx, &dir->file.fat, &tentry, fidx);
 			}
-
-			err = fat_file_dir_read(dir->ctx, &dir->file.fat, &tentry, fidx);
 		}
 
 		if (err) {
-			return err;
+			break;
 		}
 
 		if (tentry.fname[0] == 0x00 || tentry.fname[0] == 0xE5) {
@@ -550,15 +828,24 @@ static int8_t fat_op_create(struct fs_file *dir, const char *name, uint8_t attr,
 		}
 	}
 
-	if (idx != NULL) {
-		*idx = fidx;
+	if (!err) {
+		if (idx != NULL) {
+			*idx = fidx;
+		}
+
+		err = fat_file_dir_write(dir->ctx, &dir->file.fat, &dentry, fidx);
 	}
 
-	return fat_file_dir_write(dir->ctx, &dir->file.fat, &dentry, fidx);
+	lock_unlock(&dir->ctx->fat.lock);
+
+	return err;
 }
 
-static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs)
+
+static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
 {
+	(void)flags;
+
 	uint16_t cluster;
 	size_t len = 0;
 
@@ -573,7 +860,7 @@ static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uin
 		bufflen = 0x7FFF;
 	}
 
-	if (fat_fat_seek(file->ctx, &file->file.fat, &cluster, offs) != 0) {
+	if (fat_file_seek(file->ctx, &file->file.fat, &cluster, offs) != 0) {
 		return -EIO; /* EOF is not acceptable - we've checked the size */
 	}
 
@@ -606,85 +893,404 @@ static int16_t fat_op_read(struct fs_file *file, void *buff, size_t bufflen, uin
 		else if (ret < 0) {
 			return -EIO;
 		}
+
+		fat_file_cursor_set(&file->file.fat, cluster, offs);
 	}
 
 	return (int16_t)len;
 }
 
-static int8_t fat_op_truncate(struct fs_file *file, uint32_t size)
+/* Size and chain are changed in memory only, the dentry is
+ * written back by _fat_file_writeback(). When growing, bytes
+ * from the old size up to zero_end are zero-filled, the caller
+ * is going to write the rest. Slack past the end of file is
+ * left as it is. Caller holds the FAT lock. */
+static int8_t _fat_file_resize(struct fs_file *file, uint32_t size, uint32_t zero_end)
 {
 	int8_t err;
 
-	if (file->parent == NULL || !S_ISREG(file->attr)) {
-		return -EIO;
+	if (size > fat_size_max(file->ctx)) {
+		return -EFBIG;
 	}
 
-	if (file->size == size) {
+	uint16_t clusters_old = fat_sector_round_up(file->size);
+	uint16_t clusters_new = fat_sector_round_up(size);
+	uint16_t clusters_chain = clusters_old + file->file.fat.prealloc;
+	uint16_t prealloc = 0;
+
+	if ((clusters_new >= clusters_old) && (clusters_new <= clusters_chain)) {
+		/* Grows into the preallocated clusters */
+		prealloc = clusters_chain - clusters_new;
+	}
+	else {
+		err = fat_file_trim_chain(file, NULL, clusters_new, 0);
+		if (err < 0) {
+			/* Give back what has been allocated so far */
+			(void)fat_file_trim_chain(file, NULL, clusters_chain, 0);
+			return err;
+		}
+	}
+
+	if (zero_end > size) {
+		zero_end = size;
+	}
+
+	err = fat_file_zero(file, file->size, zero_end);
+	if (err < 0) {
+		if (clusters_new > clusters_chain) {
+			(void)fat_file_trim_chain(file, NULL, clusters_chain, 0);
+		}
+		return err;
+	}
+
+	file->size = size;
+	file->file.fat.prealloc = prealloc;
+	file->flags |= FS_FILE_DIRTY;
+	if (!prealloc) {
+		file->flags &= ~FS_FILE_PREALLOC;
+	}
+
+	return 0;
+}
+
+/* Caller holds the FAT lock */
+static int8_t _fat_file_writeback(struct fs_file *file)
+{
+	int8_t err;
+
+	if (!(file->flags & FS_FILE_DIRTY)) {
 		return 0;
 	}
 
-	/* Fetch dentry, we need to modify it afterwards */
 	struct fat_dentry dentry;
 	if (fat_file_dir_read(file->parent->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx)) {
 		return -EIO;
 	}
 
-	if (file->size && (file->size < size)) {
-		/* Resize up to the current last cluster */
-		uint32_t mod = file->size % FAT12_SECTOR_SIZE;
-		if (mod) {
-			uint32_t cluster_end = FAT12_SECTOR_SIZE - mod;
-			if (file->size + cluster_end > size) {
-				cluster_end = size - file->size;
-			}
+	/* Dentry must not point to a chain that is not on the disk yet.
+	 * When the file shrunk the dentry goes first instead, so a crash
+	 * leaves lost clusters rather than a size past the chain end. */
+	uint8_t grown = (file->size >= dentry.size);
 
-			uint16_t cluster;
-			err = fat_fat_seek(file->ctx, &file->file.fat, &cluster, file->size - 1);
-			if (err != 0) {
-				return -EIO;
-			}
+	if (grown) {
+		err = fat_fat_sync(file->ctx);
+		if (err < 0) {
+			return err;
+		}
+	}
 
-			if (fat_cluster_clear(file->ctx, cluster, mod, cluster_end) < 0) {
-				return -EIO;
+	dentry.size = file->size;
+	dentry.cluster = file->file.fat.cluster;
+
+	err = fat_file_dir_write(file->parent->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx);
+	if (err < 0) {
+		return err;
+	}
+
+	file->flags &= ~FS_FILE_DIRTY;
+
+	return grown ? 0 : fat_fat_sync(file->ctx);
+}
+
+static int8_t fat_op_truncate(struct fs_file *file, uint32_t size)
+{
+	if (file->parent == NULL || !S_ISREG(file->attr)) {
+		return -EIO;
+	}
+
+	if (file->size == size) {
+		return 0;
+	}
+
+	lock_lock(&file->ctx->fat.lock);
+	int8_t err = _fat_file_resize(file, size, size);
+	if (!err) {
+		/* Explicit truncate is synchronous */
+		err = _fat_file_writeback(file);
+	}
+	lock_unlock(&file->ctx->fat.lock);
+
+	return err;
+}
+
+static int8_t fat_op_fsync(struct fs_file *file)
+{
+	int8_t err = 0;
+
+	if (file->parent == NULL) {
+		return 0;
+	}
+
+	lock_lock(&file->ctx->fat.lock);
+
+	if (!file->nrefs && file->file.fat.prealloc) {
+		/* Last close, give back the unused reservation */
+		err = fat_file_trim_chain(file, NULL, fat_sector_round_up(file->size), 0);
+		if (!err) {
+			file->file.fat.prealloc = 0;
+			file->flags &= ~FS_FILE_PREALLOC;
+			file->flags |= FS_FILE_DIRTY;
+		}
+	}
+
+	if (!err) {
+		err = _fat_file_writeback(file);
+	}
+
+	lock_unlock(&file->ctx->fat.lock);
+
+	return err;
+}
+
+static int8_t fat_op_fallocate(struct fs_file *file, uint32_t len)
+{
+	if (file->parent == NULL || !S_ISREG(file->attr)) {
+		return -EINVAL;
+	}
+
+	if (len > fat_size_max(file->ctx)) {
+		return -EFBIG;
+	}
+
+	lock_lock(&file->ctx->fat.lock);
+
+	int8_t err = 0;
+	uint16_t clusters_size = fat_sector_round_up(file->size);
+	uint16_t clusters_chain = clusters_size + file->file.fat.prealloc;
+	uint16_t clusters_new = fat_sector_round_up(len);
+
+	if (clusters_new > clusters_chain) {
+		/* Reserved all at once, so they land in one run */
+		err = fat_file_trim_chain(file, NULL, clusters_new, 0);
+		if (err < 0) {
+			(void)fat_file_trim_chain(file, NULL, clusters_chain, 0);
+		}
+		else {
+			file->file.fat.prealloc = clusters_new - clusters_size;
+			file->flags |= FS_FILE_DIRTY | FS_FILE_PREALLOC;
+		}
+	}
+
+	lock_unlock(&file->ctx->fat.lock);
+
+	return err;
+}
+
+/* Caller holds the FAT lock */
+static int8_t fat_chain_stat(struct fs_ctx *ctx, uint16_t cluster, struct fat_fragstat *st)
+{
+	int8_t err;
+
+	memset(st, 0, sizeof(*st));
+
+	if ((cluster < 2) || (cluster >= ctx->fat.end)) {
+		/* Empty file or the root directory */
+		return 0;
+	}
+
+	st->first = cluster;
+	st->clusters = 1;
+	st->fragments = 1;
+
+	uint16_t next = cluster;
+	while (!(err = fat_fat_next(ctx, &next))) {
+		if (next != cluster + 1) {
+			++st->fragments;
+			if ((CLUSTER2SECTOR(next) / FAT12_CYL_SECTORS) != (CLUSTER2SECTOR(cluster) / FAT12_CYL_SECTORS)) {
+				++st->seeks;
 			}
 		}
+
+		if (++st->clusters >= ctx->fat.end) {
+			/* Looped chain */
+			return -EIO;
+		}
+
+		cluster = next;
 	}
 
-	uint16_t clusters_old = fat_sector_round_up(file->size);
-	uint16_t clusters_new = fat_sector_round_up(size);
+	return (err < 0) ? err : 0;
+}
+
+/* Caller holds the FAT lock */
+static void fat_chain_free(struct fs_ctx *ctx, uint16_t cluster)
+{
+	uint16_t next;
+
+	while ((cluster >= 2) && (cluster < ctx->fat.end)) {
+		if (fat_fat_get(ctx, cluster, &next) < 0) {
+			break;
+		}
+
+		if ((next == CLUSTER_FREE) || (next == CLUSTER_RESERVED)) {
+			break;
+		}
+
+		(void)fat_fat_set(ctx, cluster, CLUSTER_FREE);
+
+		if (next == CLUSTER_END) {
+			break;
+		}
+
+		cluster = next;
+	}
+}
+
+/* Copies the whole chain to one free run. The dentry is switched
+ * only when the new chain is on the disk, the old one is released
+ * afterwards - a crash leaves either of them in use (or both, as
+ * lost clusters). Caller holds the file and FAT locks. */
+static int8_t _fat_file_relocate(struct fs_file *file, uint16_t from)
+{
+	/* Make sure this is on stack, we cannot afford to waste that much of static memory */
+	uint8_t buff[FAT12_SECTOR_SIZE];
+	struct fs_ctx *ctx = file->ctx;
+	struct fat_fragstat st;
+
+	int8_t err = fat_chain_stat(ctx, file->file.fat.cluster, &st);
+	if (err < 0 || !st.clusters || (!from && (st.fragments == 1))) {
+		return err;
+	}
+
+	uint16_t run = fat_fat_find_run(ctx, from, st.clusters);
+	if (!run) {
+		return -ENOSPC;
+	}
+
+	if ((st.fragments == 1) && (run >= st.first)) {
+		/* Would not get any closer */
+		return 0;
+	}
+
+	uint16_t src = st.first;
+	uint16_t dst = run - 1;
+	uint16_t head = 0;
 
-	if (clusters_new != clusters_old) {
-		err = fat_file_trim_chain(file, &dentry, clusters_new);
+	for (uint16_t i = 0; i < st.clusters; ++i) {
+		uint16_t prev = dst;
+
+		err = fat_fat_allocate_cluster(ctx, prev, &dst);
 		if (err < 0) {
-			fat_fat_fetch(file->ctx);
-			return err;
+			break;
+		}
+
+		/* Chain stays terminated, it can be freed at any point */
+		(void)fat_fat_set(ctx, dst, CLUSTER_END);
+		if (!head) {
+			head = dst;
+		}
+		else {
+			(void)fat_fat_set(ctx, prev, dst);
+		}
+
+		if ((ctx->cb->read(fat_sector_offset(CLUSTER2SECTOR(src)), buff, sizeof(buff)) != sizeof(buff)) ||
+				(ctx->cb->write(fat_sector_offset(CLUSTER2SECTOR(dst)), buff, sizeof(buff)) != sizeof(buff))) {
+			err = -EIO;
+			break;
+		}
+
+		if ((i + 1 < st.clusters) && (fat_fat_next(ctx, &src) != 0)) {
+			err = -EIO;
+			break;
 		}
 	}
 
-	file->size = size;
-	dentry.size = size;
+	if (!err) {
+		err = fat_fat_sync(ctx);
+	}
+
+	if (!err) {
+		file->file.fat.cluster = head;
+		file->file.fat.curr = 0;
+		file->flags |= FS_FILE_DIRTY;
+
+		err = _fat_file_writeback(file);
+		if (err < 0) {
+			file->file.fat.cluster = st.first;
+		}
+	}
 
-	return fat_file_dir_write(file->parent->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx);
+	if (err < 0) {
+		fat_chain_free(ctx, head);
+		return err;
+	}
+
+	fat_chain_free(ctx, st.first);
+
+	return fat_fat_sync(ctx);
 }
 
-static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs)
+static int8_t fat_op_ioctl(struct fs_file *file, int16_t op, uint8_t flags, va_list arg)
 {
+	int8_t err;
+
+	switch (op) {
+		case FAT_IOC_FRAGSTAT: {
+			struct fat_fragstat *st = va_arg(arg, struct fat_fragstat *);
+
+			lock_lock(&file->ctx->fat.lock);
+			err = fat_chain_stat(file->ctx, file->file.fat.cluster, st);
+			lock_unlock(&file->ctx->fat.lock);
+
+			return err;
+		}
+
+		case FAT_IOC_DEFRAG: {
+			const uint16_t *from = va_arg(arg, const uint16_t *);
+
+			if (flags & O_RDONLY) {
+				/* Rewrites the file like a write would */
+				return -EBADF;
+			}
+
+			if ((file->parent == NULL) || !S_ISREG(file->attr)) {
+				/* Directories would need their dot entries updated */
+				return -EINVAL;
+			}
+
+			lock_lock(&file->ctx->fat.lock);
+			err = _fat_file_relocate(file, *from);
+			lock_unlock(&file->ctx->fat.lock);
+
+			return err;
+		}
+
+		default:
+			return -ENOSYS;
+	}
+}
+
+static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
+{
+	(void)flags;
+
 	size_t len = 0;
-	int err;
+	int err = 0;
 	uint16_t cluster;
+	uint32_t size_old = file->size;
 
 	if (file->size < offs + (uint32_t)bufflen) {
-		err = fat_op_truncate(file, offs + (uint32_t)bufflen);
+		if (file->parent == NULL || !S_ISREG(file->attr)) {
+			return -EIO;
+		}
+
+		/* Dentry is updated on fsync, close or sync, so appends
+		 * do not rewrite the directory sector every time. Only
+		 * a hole before offs is zero-filled, the payload is
+		 * written straight to the new clusters. */
+		lock_lock(&file->ctx->fat.lock);
+		err = _fat_file_resize(file, offs + (uint32_t)bufflen, offs);
+		lock_unlock(&file->ctx->fat.lock);
 		if (err < 0) {
 			return err;
 		}
 	}
 
-	if (fat_fat_seek(file->ctx, &file->file.fat, &cluster, offs) != 0) {
-		return -EIO; /* EOF is not acceptable - we've checked the size */
+	if (fat_file_seek(file->ctx, &file->file.fat, &cluster, offs) != 0) {
+		err = -EIO; /* EOF is not acceptable - we've checked the size */
 	}
 
-	while (1) {
+	while (!err) {
 		uint16_t missalign = offs % (uint32_t)FAT12_SECTOR_SIZE;
 		size_t chunk = FAT12_SECTOR_SIZE - missalign;
 		if (chunk > bufflen - len) {
@@ -693,8 +1299,9 @@ static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t buffl
 
 		err = file->ctx->cb->write(fat_sector_offset(CLUSTER2SECTOR(cluster)) + missalign, (uint8_t *)buff + len, chunk);
 		if (err < 0) {
-			return err;
+			break;
 		}
+		err = 0;
 
 		offs += chunk;
 		len += chunk;
@@ -704,8 +1311,22 @@ static int16_t fat_op_write(struct fs_file *file, const void *buff, size_t buffl
 		}
 
 		if (fat_fat_next(file->ctx, &cluster) != 0) {
-			return -EIO;
+			err = -EIO;
+			break;
+		}
+
+		fat_file_cursor_set(&file->file.fat, cluster, offs);
+	}
+
+	if (err < 0) {
+		if (file->size != size_old) {
+			/* New clusters were not zero-filled, do not expose
+			 * whatever they held before */
+			lock_lock(&file->ctx->fat.lock);
+			(void)_fat_file_resize(file, size_old, size_old);
+			lock_unlock(&file->ctx->fat.lock);
 		}
+		return err;
 	}
 
 	return len;
@@ -719,6 +1340,40 @@ static int32_t fat_attr2epoch(uint16_t date, uint16_t time)
 	return 0;
 }
 
+static int8_t fat_dentry_decode(const struct fat_dentry *fentry, struct fs_dentry *dentry)
+{
+	dentry->atime = fat_attr2epoch(fentry->adate, 0);
+	dentry->ctime = fat_attr2epoch(fentry->cdate, fentry->ctime);
+	dentry->mtime = fat_attr2epoch(fentry->mdate, fentry->mtime);
+
+	memcpy(dentry->name, fentry->fname, sizeof(fentry->fname));
+	uint8_t pos = sizeof(fentry->fname) - 1;
+	while (dentry->name[pos] == ' ') {
+		if (!pos) {
+			return -EIO;
+		}
+		--pos;
+	}
+
+	uint8_t ppos = ++pos;
+	dentry->name[pos] = ' ';
+	memcpy(dentry->name + pos + 1, fentry->extension, sizeof(fentry->extension));
+	pos += sizeof(fentry->extension);
+	while (dentry->name[pos] == ' ') {
+		--pos;
+	}
+
+	if (ppos != pos) {
+		dentry->name[ppos] = '.';
+	}
+
+	dentry->name[pos + 1] = '\0';
+	dentry->attr = fat_fat2attr(fentry->attr);
+	dentry->size = fentry->size;
+
+	return 0;
+}
+
 static int8_t fat_op_readdir(struct fs_file *dir, struct fs_dentry *dentry, union fs_file_internal *file, uint16_t idx)
 {
 	int err;
@@ -740,42 +1395,62 @@ static int8_t fat_op_readdir(struct fs_file *dir, struct fs_dentry *dentry, unio
 	}
 
 	/* Found valid entry */
+	err = fat_dentry_decode(&fentry, dentry);
+	if (err) {
+		return err;
+	}
 
-	dentry->atime = fat_attr2epoch(fentry.adate, 0);
-	dentry->ctime = fat_attr2epoch(fentry.cdate, fentry.ctime);
-	dentry->mtime = fat_attr2epoch(fentry.mdate, fentry.mtime);
+	if (file != NULL) {
+		file->fat.cluster = fentry.cluster;
+		file->fat.idx = idx;
+		file->fat.curr = 0;
+		file->fat.prealloc = 0;
+	}
 
-	memcpy(dentry->name, fentry.fname, sizeof(fentry.fname));
-	uint8_t pos = sizeof(fentry.fname) - 1;
-	while (dentry->name[pos] == ' ') {
-		if (!pos) {
-			return -EIO;
+	return err;
+}
+
+/* Whole rest of a directory sector is fetched at once and decoded
+ * in place, instead of a chain seek and a device read per entry */
+static int16_t fat_op_getdents(struct fs_file *dir, struct fs_dentry *dentries, uint8_t count, uint16_t *idx)
+{
+	struct fat_dentry sentries[FAT12_SECTOR_SIZE / sizeof(struct fat_dentry)];
+	int16_t ret = 0;
+
+	while (ret < count) {
+		uint16_t sector, offset;
+		int8_t err = fat_file_dir_access(dir->ctx, &dir->file.fat, *idx, &sector, &offset);
+		if (err == -ENOENT) {
+			break;
+		}
+		else if (err < 0) {
+			return ret ? ret : err;
 		}
-		--pos;
-	}
 
-	uint8_t ppos = ++pos;
-	dentry->name[pos] = ' ';
-	memcpy(dentry->name + pos + 1, fentry.extension, sizeof(fentry.extension));
-	pos += sizeof(fentry.extension);
-	while (dentry->name[pos] == ' ') {
-		--pos;
-	}
+		uint16_t len = FAT12_SECTOR_SIZE - offset;
+		if (dir->ctx->cb->read(fat_sector_offset(sector) + offset, sentries, len) < 0) {
+			return ret ? ret : -EIO;
+		}
 
-	if (ppos != pos) {
-		dentry->name[ppos] = '.';
-	}
+		for (uint8_t i = 0; (i < len / sizeof(struct fat_dentry)) && (ret < count); ++i) {
+			if (sentries[i].fname[0] == 0x00) {
+				/* Last record reached */
+				return ret;
+			}
 
-	dentry->name[pos + 1] = '\0';
-	dentry->attr = fat_fat2attr(fentry.attr);
-	dentry->size = fentry.size;
+			if (sentries[i].fname[0] != 0xE5) {
+				err = fat_dentry_decode(&sentries[i], &dentries[ret]);
+				if (err < 0) {
+					return ret ? ret : err;
+				}
+				++ret;
+			}
 
-	if (file != NULL) {
-		file->fat.cluster = fentry.cluster;
-		file->fat.idx = idx;
+			++(*idx);
+		}
 	}
 
-	return err;
+	return ret;
 }
 
 static int8_t fat_op_move(struct fs_file *file, struct fs_file *ndir, const char *name)
@@ -787,26 +1462,43 @@ static int8_t fat_op_move(struct fs_file *file, struct fs_file *ndir, const char
 	return -ENOSYS;
 }
 
+static int8_t fat_op_statfs(struct fs_file *file, struct statfs *buf)
+{
+	buf->f_bsize = FAT12_SECTOR_SIZE;
+	buf->f_blocks = file->ctx->fat.end - 2;
+	buf->f_bfree = file->ctx->fat.free;
+
+	return 0;
+}
+
 static int8_t fat_op_remove(struct fs_file *file)
 {
 	struct fat_dentry dentry;
+
+	lock_lock(&file->ctx->fat.lock);
+
 	int8_t err = fat_file_dir_read(file->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx);
-	if (err) {
-		return err;
-	}
+	if (!err) {
+		/* No directory shrinking (trimming the fat chain)!
+		 * Linux vfat does not care, so neither do I (for now)
+		 * Just mark as deleted */
+		dentry.fname[0] = 0xE5;
 
-	/* No directory shrinking (trimming the fat chain)!
-	 * Linux vfat does not care, so neither do I (for now)
-	 * Just mark as deleted */
-	dentry.fname[0] = 0xE5;
+		/* Trim file to zero - free all clusters. Freed
+		 * clusters reach the disk with the next FAT flush. */
+		err = fat_file_trim_chain(file, &dentry, 0, 0);
+	}
 
-	/* Trim file to zero - free all clusters */
-	err = fat_file_trim_chain(file, &dentry, 0);
-	if (err) {
-		return err;
+	if (!err) {
+		/* Nothing to write back anymore */
+		file->file.fat.prealloc = 0;
+		file->flags &= ~(FS_FILE_DIRTY | FS_FILE_PREALLOC);
+		err = fat_file_dir_write(file->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx);
 	}
 
-	return fat_file_dir_write(file->ctx, &file->parent->file.fat, &dentry, file->file.fat.idx);
+	lock_unlock(&file->ctx->fat.lock);
+
+	return err;
 }
 
 static int8_t fat_op_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_file *root)
@@ -847,6 +1539,11 @@ static int8_t fat_op_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_fi
 		return -EIO;
 	}
 
+	/* Clusters are numbered from 2 */
+	ctx->fat.end = fat_sector_round_down(ctx->cb->size) - FAT12_DATA_START + 2;
+	ctx->fat.hint = 2;
+	lock_init(&ctx->fat.lock);
+
 	/* Alloc FAT cache */
 	ctx->fat.fat_page[0] = page_alloc(NULL, 1);
 	if (ctx->fat.fat_page[0] == 0) {
@@ -876,8 +1573,20 @@ static int8_t fat_op_mount(struct fs_ctx *ctx, struct fs_file *dir, struct fs_fi
 	return 0;
 }
 
+static int8_t fat_op_sync(struct fs_ctx *ctx)
+{
+	lock_lock(&ctx->fat.lock);
+	int8_t err = fat_fat_sync(ctx);
+	lock_unlock(&ctx->fat.lock);
+
+	if (ctx->cb->sync(0, 0) < 0) {
+		err = -EIO;
+	}
+
+	return err;
+}
+
 static int8_t fat_op_unmount(struct fs_ctx *ctx)
 {
-	ctx->cb->sync(0, 0);
-	return 0;
+	return fat_op_sync(ctx);
 }
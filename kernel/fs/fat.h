@@ -9,6 +9,8 @@
 
 #include <stdint.h>
 
+#include "proc/lock.h"
+
 #define FAT12_ATTR_READONLY (1 << 0)
 #define FAT12_ATTR_HIDDEN   (1 << 1)
 #define FAT12_ATTR_SYSTEM   (1 << 2)
@@ -39,11 +41,33 @@ struct fat_dentry {
 struct fat_file {
 	uint16_t cluster;
 	uint16_t idx;
+
+	/* Chain cursor - cluster number pos (in the chain) is curr,
+	 * valid when curr != 0. Regular files only, under file lock. */
+	uint16_t curr;
+	uint16_t pos;
+
+	/* Clusters reserved past the end of file (fallocate),
+	 * given back on the last close. Under the FAT lock. */
+	uint16_t prealloc;
 };
 
 struct fat_ctx {
+	/* Protects the FAT, its bitmap and the chains */
+	struct lock lock;
+
+	/* Decoded FAT, uint16_t per cluster */
 	uint8_t fat_page[2];
+
+	/* Bitmask of FAT sectors to be packed and written back */
 	uint16_t fat_dirty;
+
+	/* Clusters 2 to end - 1 */
+	uint16_t end;
+	uint16_t free;
+
+	/* Next free cluster search start */
+	uint16_t hint;
 };
 
 #endif
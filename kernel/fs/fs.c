@@ -8,22 +8,69 @@
 #include <string.h>
 
 #include "fs/fs.h"
+#include "fs/dcache.h"
 #include "proc/lock.h"
 #include "lib/errno.h"
+#include "lib/lockstat.h"
 #include "lib/assert.h"
 #include "lib/list.h"
 #include "mem/kmalloc.h"
 
+/* kmalloc memory kept in unreferenced fs_file nodes */
+#define FS_ICACHE_BUDGET 768
+
 static struct {
 	struct lock lock;
+	struct lock_stat lstat;
+	struct lock_stat flstat;
 	struct fs_file *root;
+	struct fs_ctx *mounts;
+
+	/* Unreferenced nodes still linked in the tree, oldest first */
+	struct fs_file *unused;
+	size_t unused_size;
+	struct kmalloc_shrinker shrinker;
 } common;
 
+static size_t fs_file_footprint(struct fs_file *file)
+{
+	return sizeof(struct fs_file) + strlen(file->name) + 1;
+}
+
 static void fs_file_get(struct fs_file *file)
 {
+	if (file->lnext != NULL) {
+		/* Reused from the cache */
+		LIST_REMOVE(&common.unused, file, struct fs_file, lnext, lprev);
+		common.unused_size -= fs_file_footprint(file);
+	}
+
 	++file->nrefs;
 }
 
+static int8_t fs_file_put(struct fs_file *file);
+
+static void fs_file_free(struct fs_file *file)
+{
+	assert(file->mountpoint == NULL);
+	assert(file->children == NULL);
+
+	if (file->parent != NULL) {
+		if (!(file->flags & (FS_FILE_REMOVED | FS_FILE_DIRTY))) {
+			/* Reopening it will not need a directory scan */
+			dcache_insert(file->parent, file->name, file->attr, file->size, &file->file);
+		}
+		LIST_REMOVE(&file->parent->children, file, struct fs_file, chnext, chprev);
+		(void)fs_file_put(file->parent);
+	}
+
+	if ((file->ctx != NULL) && (file->ctx->op->release != NULL)) {
+		file->ctx->op->release(file);
+	}
+
+	kfree(file);
+}
+
 static int8_t fs_file_put(struct fs_file *file)
 {
 	int8_t ret = 0;
@@ -32,20 +79,84 @@ static int8_t fs_file_put(struct fs_file *file)
 	assert(file->nrefs >= 0);
 
 	if (!file->nrefs) {
-		assert(file->mountpoint == NULL);
-		assert(file->children == NULL);
-
-		if (file->parent != NULL) {
-			LIST_REMOVE(&file->parent->children, file, struct fs_file, chnext, chprev);
-			(void)fs_file_put(file->parent);
+		if ((file->flags & (FS_FILE_DIRTY | FS_FILE_PREALLOC)) && !(file->flags & FS_FILE_REMOVED)) {
+			/* Last close writes the deferred metadata back */
+			ret = file->ctx->op->fsync(file);
 		}
 
-		kfree(file);
+		if ((file->parent != NULL) && !(file->flags & FS_FILE_REMOVED)) {
+			if (!(file->flags & FS_FILE_DIRTY)) {
+				/* Keep it in the tree, _fs_lookup() finds it
+				 * without I/O. Trimmed by _fs_icache_shrink(). */
+				LIST_ADD(&common.unused, file, struct fs_file, lnext, lprev);
+				common.unused_size += fs_file_footprint(file);
+			}
+			/* else writeback failed, the node stays in the tree (out
+			 * of the cache) until fs_sync() manages to write it back */
+		}
+		else {
+			fs_file_free(file);
+		}
 	}
 
 	return ret;
 }
 
+/* Frees the oldest unreferenced nodes until the cache fits in budget.
+ * Freeing a node can make its parent unreferenced, it is cached then.
+ * Caller holds common.lock. */
+static uint8_t _fs_icache_shrink(size_t budget)
+{
+	uint8_t freed = 0;
+
+	while ((common.unused != NULL) && (common.unused_size > budget)) {
+		struct fs_file *file = common.unused;
+
+		LIST_REMOVE(&common.unused, file, struct fs_file, lnext, lprev);
+		common.unused_size -= fs_file_footprint(file);
+		fs_file_free(file);
+		freed = 1;
+	}
+
+	return freed;
+}
+
+/* Frees the unreferenced children of dir only. Caller holds common.lock. */
+static void _fs_icache_evict_children(struct fs_file *dir)
+{
+	struct fs_file *file = common.unused;
+
+	while (file != NULL) {
+		if (file->parent == dir) {
+			LIST_REMOVE(&common.unused, file, struct fs_file, lnext, lprev);
+			common.unused_size -= fs_file_footprint(file);
+			fs_file_free(file);
+
+			/* List has changed, start over */
+			file = common.unused;
+			continue;
+		}
+
+		file = file->lnext;
+		if (file == common.unused) {
+			break;
+		}
+	}
+}
+
+static uint8_t fs_icache_reclaim(void)
+{
+	/* kmalloc might have been called under the fs lock */
+	if (lock_try(&common.lock) < 0) {
+		return 0;
+	}
+
+	uint8_t freed = _fs_icache_shrink(0);
+	lock_unlock(&common.lock);
+
+	return freed;
+}
+
 static struct fs_file *fs_file_spawn(const char *name, uint8_t attr)
 {
 	struct fs_file *file = kmalloc(sizeof(struct fs_file) + strlen(name) + 1);
@@ -55,6 +166,17 @@ static struct fs_file *fs_file_spawn(const char *name, uint8_t attr)
 		file->nrefs = 0;
 		strcpy(file->name, name);
 		lock_init(&file->lock);
+		lockstat_register(&file->lock, &common.flstat, "fs_file");
+	}
+	return file;
+}
+
+struct fs_file *fs_file_anon(struct fs_ctx *ctx, uint8_t attr)
+{
+	struct fs_file *file = fs_file_spawn("", attr);
+	if (file != NULL) {
+		file->ctx = ctx;
+		file->nrefs = 1;
 	}
 	return file;
 }
@@ -85,11 +207,53 @@ static int8_t fs_is_tail(const char *path)
 	return 1;
 }
 
+static int8_t fs_file_attach(struct fs_file *dir, const struct fs_dentry *dentry, const union fs_file_internal *internal, struct fs_file **fnew)
+{
+	struct fs_file *f = fs_file_spawn(dentry->name, dentry->attr);
+	if (f == NULL) {
+		/* dir (and so its ancestors) might be cached too, pin it */
+		fs_file_get(dir);
+		if (_fs_icache_shrink(0)) {
+			f = fs_file_spawn(dentry->name, dentry->attr);
+		}
+		(void)fs_file_put(dir);
+	}
+	if (f == NULL) {
+		return -ENOMEM;
+	}
+
+	f->parent = dir;
+	f->ctx = dir->ctx;
+	f->size = dentry->size;
+	memcpy(&f->file, internal, sizeof(*internal));
+
+	LIST_ADD(&dir->children, f, struct fs_file, chnext, chprev);
+	fs_file_get(dir);
+
+	*fnew = f;
+
+	return 0;
+}
+
+/* -EAGAIN - not cached, directory has to be scanned,
+ * -ENOENT - cached as missing */
+static int8_t _fs_open_cached(struct fs_file *dir, const char *path, struct fs_file **fnew)
+{
+	struct fs_dentry dentry;
+	union fs_file_internal internal;
+
+	int8_t err = dcache_lookup(dir, path, &dentry, &internal);
+	if (err) {
+		return err;
+	}
+
+	return fs_file_attach(dir, &dentry, &internal, fnew);
+}
+
 static int8_t _fs_open_from_dir(struct fs_file *dir, const char *path, struct fs_file **fnew, uint16_t sidx)
 {
 	struct fs_dentry dentry;
 	union fs_file_internal internal;
-	struct fs_file *f;
 
 	for (;; ++sidx) {
 		int8_t err = dir->ctx->op->readdir(dir, &dentry, &internal, sidx);
@@ -101,22 +265,7 @@ static int8_t _fs_open_from_dir(struct fs_file *dir, const char *path, struct fs
 		}
 
 		if (!fs_namecmp(path, dentry.name)) {
-			f = fs_file_spawn(dentry.name, dentry.attr);
-			if (f == NULL) {
-				return -ENOMEM;
-			}
-
-			f->parent = dir;
-			f->ctx = dir->ctx;
-			f->size = dentry.size;
-			memcpy(&f->file, &internal, sizeof(internal));
-
-			LIST_ADD(&dir->children, f, struct fs_file, chnext, chprev);
-			fs_file_get(dir);
-
-			*fnew = f;
-
-			return 0;
+			return fs_file_attach(dir, &dentry, &internal, fnew);
 		}
 	}
 }
@@ -152,7 +301,7 @@ static int8_t _fs_lookup(const char **path, struct fs_file **file, struct fs_fil
 		return 0;
 	}
 
-	while (*path != '\0') {
+	while (**path != '\0') {
 		if (!S_ISDIR((*dir)->attr)) {
 			return -ENOTDIR;
 		}
@@ -213,11 +362,18 @@ static int8_t _fs_open(const char *path, struct fs_file **file, uint8_t mode, ui
 			}
 
 			lock_lock(&dir->lock);
-			err = _fs_open_from_dir(dir, path, file, 0);
+			err = _fs_open_cached(dir, path, file);
+			if (err == -EAGAIN) {
+				err = _fs_open_from_dir(dir, path, file, 0);
+				if (err == -ENOENT) {
+					dcache_insert_negative(dir, path);
+				}
+			}
 			if (err == -ENOENT && (mode & O_CREAT) && fs_is_tail(path)) {
 				uint16_t idx;
 				err = dir->ctx->op->create(dir, path, attr, &idx);
 				if (!err) {
+					dcache_invalidate(dir, path);
 					err = _fs_open_from_dir(dir, path, file, idx);
 				}
 			}
@@ -250,6 +406,7 @@ int8_t fs_open(const char *path, struct fs_file **file, uint8_t mode, uint8_t at
 {
 	lock_lock(&common.lock);
 	int8_t err = _fs_open(path, file, mode, attr);
+	(void)_fs_icache_shrink(FS_ICACHE_BUDGET);
 	lock_unlock(&common.lock);
 
 	return err;
@@ -266,15 +423,36 @@ int8_t fs_close(struct fs_file *file)
 {
 	lock_lock(&common.lock);
 	int8_t ret = fs_file_put(file);
+	(void)_fs_icache_shrink(FS_ICACHE_BUDGET);
 	lock_unlock(&common.lock);
 
 	return ret;
 }
 
+void fs_lock(struct fs_file *file)
+{
+	lock_lock(&file->lock);
+}
+
+void fs_unlock(struct fs_file *file)
+{
+	lock_unlock(&file->lock);
+}
+
+int16_t _fs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
+{
+	return file->ctx->op->read(file, buff, bufflen, offs, flags);
+}
+
+int16_t _fs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
+{
+	return file->ctx->op->write(file, buff, bufflen, offs, flags);
+}
+
 int16_t fs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs)
 {
 	lock_lock(&file->lock);
-	int16_t ret = file->ctx->op->read(file, buff, bufflen, offs);
+	int16_t ret = _fs_read(file, buff, bufflen, offs, 0);
 	lock_unlock(&file->lock);
 
 	return ret;
@@ -283,7 +461,7 @@ int16_t fs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs)
 int16_t fs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs)
 {
 	lock_lock(&file->lock);
-	int16_t ret = file->ctx->op->write(file, buff, bufflen, offs);
+	int16_t ret = _fs_write(file, buff, bufflen, offs, 0);
 	lock_unlock(&file->lock);
 
 	return ret;
@@ -298,6 +476,35 @@ int8_t fs_truncate(struct fs_file *file, uint32_t size)
 	return ret;
 }
 
+int8_t fs_fsync(struct fs_file *file)
+{
+	if (file->ctx->op->fsync == NULL) {
+		return 0;
+	}
+
+	lock_lock(&file->lock);
+	int8_t ret = 0;
+	if (file->flags & FS_FILE_DIRTY) {
+		ret = file->ctx->op->fsync(file);
+	}
+	lock_unlock(&file->lock);
+
+	return ret;
+}
+
+int8_t fs_fallocate(struct fs_file *file, uint32_t len)
+{
+	if (file->ctx->op->fallocate == NULL) {
+		return -ENOSYS;
+	}
+
+	lock_lock(&file->lock);
+	int8_t ret = file->ctx->op->fallocate(file, len);
+	lock_unlock(&file->lock);
+
+	return ret;
+}
+
 int8_t fs_readdir(struct fs_file *dir, struct fs_dentry *dentry, uint16_t idx)
 {
 	if (!S_ISDIR(dir->attr)) {
@@ -311,6 +518,46 @@ int8_t fs_readdir(struct fs_file *dir, struct fs_dentry *dentry, uint16_t idx)
 	return ret;
 }
 
+int16_t fs_getdents(struct fs_file *dir, struct fs_dentry *dentries, uint8_t count, uint16_t *idx)
+{
+	if (!S_ISDIR(dir->attr)) {
+		return -ENOTDIR;
+	}
+
+	int16_t ret = 0;
+
+	lock_lock(&dir->lock);
+
+	if (dir->ctx->op->getdents != NULL) {
+		ret = dir->ctx->op->getdents(dir, dentries, count, idx);
+	}
+	else {
+		union fs_file_internal internal;
+
+		while (ret < count) {
+			int8_t err = dir->ctx->op->readdir(dir, &dentries[ret], &internal, *idx);
+			if (err == -ENOENT) {
+				break;
+			}
+			else if ((err < 0) && (err != -EAGAIN)) {
+				if (!ret) {
+					ret = err;
+				}
+				break;
+			}
+
+			++(*idx);
+			if (!err) {
+				++ret;
+			}
+		}
+	}
+
+	lock_unlock(&dir->lock);
+
+	return ret;
+}
+
 int8_t fs_move(struct fs_file *file, struct fs_file *ndir, const char *name)
 {
 }
@@ -326,6 +573,11 @@ int8_t fs_remove(const char *path)
 		return err;
 	}
 
+	if ((file->nrefs != 1) && S_ISDIR(file->attr)) {
+		/* Cached children keep the directory referenced */
+		_fs_icache_evict_children(file);
+	}
+
 	if (file->nrefs != 1) {
 		(void)fs_file_put(file);
 		lock_unlock(&common.lock);
@@ -333,26 +585,126 @@ int8_t fs_remove(const char *path)
 	}
 
 	err = file->ctx->op->remove(file);
+	if (!err) {
+		file->flags |= FS_FILE_REMOVED;
+		/* Entry cached by an earlier close points at the freed chain */
+		dcache_insert_negative(file->parent, file->name);
+		if (S_ISDIR(file->attr)) {
+			dcache_purge(file);
+		}
+	}
 	(void)fs_file_put(file);
+	(void)_fs_icache_shrink(FS_ICACHE_BUDGET);
 
 	lock_unlock(&common.lock);
 
 	return err;
 }
 
-int8_t fs_ioctl(struct fs_file *file, int16_t op, ...)
+int8_t fs_ioctl(struct fs_file *file, int16_t op, uint8_t flags, ...)
 {
 	if (file->ctx->op->ioctl == NULL) return -ENOSYS;
 
 	va_list args;
-	va_start(args, op);
+	va_start(args, flags);
 	lock_lock(&file->lock);
-	int8_t ret = file->ctx->op->ioctl(file, op, args);
+	int8_t ret = file->ctx->op->ioctl(file, op, flags, args);
 	lock_unlock(&file->lock);
 	va_end(args);
 	return ret;
 }
 
+uint8_t fs_poll(struct fs_file *file, uint8_t events)
+{
+	if (file->ctx->op->poll == NULL) {
+		return events;
+	}
+
+	return file->ctx->op->poll(file, events);
+}
+
+int8_t fs_statfs(struct fs_file *file, struct statfs *buf)
+{
+	if (file->ctx->op->statfs == NULL) {
+		return -ENOSYS;
+	}
+
+	lock_lock(&file->lock);
+	int8_t ret = file->ctx->op->statfs(file, buf);
+	lock_unlock(&file->lock);
+
+	return ret;
+}
+
+/* Caller holds common.lock */
+static int8_t _fs_sync_tree(struct fs_file *dir)
+{
+	int8_t ret = 0;
+	int8_t err;
+	struct fs_file *file = dir->children;
+
+	if (file != NULL) {
+		do {
+			if (file->flags & FS_FILE_DIRTY) {
+				lock_lock(&file->lock);
+				err = (file->flags & FS_FILE_DIRTY) ? file->ctx->op->fsync(file) : 0;
+				lock_unlock(&file->lock);
+				if (err < 0) {
+					ret = err;
+				}
+				else if (!file->nrefs && (file->lnext == NULL)) {
+					/* Left by a failed last close, it can be cached now */
+					LIST_ADD(&common.unused, file, struct fs_file, lnext, lprev);
+					common.unused_size += fs_file_footprint(file);
+				}
+			}
+
+			if (S_ISDIR(file->attr)) {
+				err = _fs_sync_tree(file);
+				if (err < 0) {
+					ret = err;
+				}
+			}
+
+			file = file->chnext;
+		} while (file != dir->children);
+	}
+
+	if (dir->mountpoint != NULL) {
+		err = _fs_sync_tree(dir->mountpoint);
+		if (err < 0) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
+int8_t fs_sync(void)
+{
+	int8_t ret = 0;
+
+	lock_lock(&common.lock);
+	if (common.root != NULL) {
+		ret = _fs_sync_tree(common.root);
+	}
+	/* Contexts are never unlinked, no need to hold
+	 * the fs lock during the (slow) writeback */
+	struct fs_ctx *ctx = common.mounts;
+	lock_unlock(&common.lock);
+
+	for (; ctx != NULL; ctx = ctx->next) {
+		if (ctx->op->sync != NULL) {
+			int8_t err = ctx->op->sync(ctx);
+			if (err < 0) {
+				ret = err;
+			}
+		}
+	}
+
+	return ret;
+}
+
 int8_t fs_mount(struct fs_ctx *ctx, const struct fs_file_op *op, struct dev_blk *cb, struct fs_file *dir)
 {
 	lock_lock(&common.lock);
@@ -398,6 +750,9 @@ int8_t fs_mount(struct fs_ctx *ctx, const struct fs_file_op *op, struct dev_blk
 
 	fs_file_get(rootdir);
 
+	ctx->next = common.mounts;
+	common.mounts = ctx;
+
 	lock_unlock(&common.lock);
 
 	return 0;
@@ -413,4 +768,9 @@ int8_t fs_unmount(struct fs_file *mountpoint)
 void fs_init(void)
 {
 	lock_init(&common.lock);
+	lockstat_register(&common.lock, &common.lstat, "fs");
+	dcache_init();
+
+	common.shrinker.shrink = fs_icache_reclaim;
+	kmalloc_shrinker_register(&common.shrinker);
 }
@@ -18,11 +18,22 @@
 #include "proc/timer.h"
 #include "fs/fat.h"
 #include "fs/devfs.h"
+#include "fs/pipe.h"
 
 #include <sys/fs.h>
+#include <sys/statfs.h>
 
 #define FS_TYPE_FAT   0x01
 #define FS_TYPE_DEVFS 0x02
+#define FS_TYPE_PIPE  0x03
+
+/* fs_file flags */
+#define FS_FILE_REMOVED (1 << 0) /* Gone from the directory, do not cache */
+#define FS_FILE_DIRTY   (1 << 1) /* Metadata changed in memory only, see fsync */
+#define FS_FILE_PREALLOC (1 << 2) /* Holds space past the end, fsync on the last close gives it back */
+
+/* Period of the background metadata writeback (ms) */
+#define FS_FLUSH_INTERVAL 5000
 
 struct fs_file_op;
 
@@ -36,11 +47,15 @@ struct fs_ctx {
 	struct dev_blk *cb;
 	const struct fs_file_op *op;
 	uint8_t type;
+
+	/* Mounted filesystems */
+	struct fs_ctx *next;
 };
 
 union fs_file_internal {
 	struct fat_file fat;
 	struct devfs_file devfs;
+	struct pipe_file pipe;
 };
 
 struct fs_file {
@@ -62,9 +77,16 @@ struct fs_file {
 	struct fs_file *chnext;
 	struct fs_file *chprev;
 
+	/* Unreferenced nodes cache, lnext != NULL while in it */
+	struct fs_file *lnext;
+	struct fs_file *lprev;
+
 	/* File type and permissions */
 	uint8_t attr;
 
+	/* FS_FILE_* */
+	uint8_t flags;
+
 	off_t size;
 
 	/* File system context */
@@ -74,28 +96,60 @@ struct fs_file {
 };
 
 struct fs_file_op {
-	int16_t (*read)(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs);
-	int16_t (*write)(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs);
+	/* flags - O_NONBLOCK of the open file */
+	int16_t (*read)(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
+	int16_t (*write)(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
 	int8_t (*create)(struct fs_file *dir, const char *name, uint8_t attr, uint16_t *idx);
 	int8_t (*truncate)(struct fs_file *file, uint32_t size);
 	int8_t (*readdir)(struct fs_file *dir, struct fs_dentry *dentry, union fs_file_internal *file, uint16_t idx);
+	/* Fills up to count entries from *idx on and advances *idx,
+	 * returns the number of entries, optional (readdir is used) */
+	int16_t (*getdents)(struct fs_file *dir, struct fs_dentry *dentries, uint8_t count, uint16_t *idx);
 	int8_t (*move)(struct fs_file *file, struct fs_file *ndir, const char *name);
 	int8_t (*remove)(struct fs_file *file);
-	int8_t (*ioctl)(struct fs_file *file, int16_t op, va_list arg);
+	int8_t (*ioctl)(struct fs_file *file, int16_t op, uint8_t flags, va_list arg);
+	uint8_t (*poll)(struct fs_file *file, uint8_t events);
+	/* Statistics of the fs the file is on, optional */
+	int8_t (*statfs)(struct fs_file *file, struct statfs *buf);
+	/* Writes back metadata of the FS_FILE_DIRTY file, called
+	 * under the file lock or with no references, optional */
+	int8_t (*fsync)(struct fs_file *file);
+	/* Reserves space for len bytes, size is not changed, optional */
+	int8_t (*fallocate)(struct fs_file *file, uint32_t len);
+	/* Writes back metadata kept in memory, optional */
+	int8_t (*sync)(struct fs_ctx *ctx);
 	int8_t (*mount)(struct fs_ctx *ctx, struct fs_file *dir, struct fs_file *root);
 	int8_t (*unmount)(struct fs_ctx *ctx);
+
+	/* Last reference dropped, optional */
+	void (*release)(struct fs_file *file);
 };
 
+/* File outside of the directory tree (e.g. pipe end), closed with fs_close() */
+struct fs_file *fs_file_anon(struct fs_ctx *ctx, uint8_t attr);
 int8_t fs_open(const char *path, struct fs_file **file, uint8_t mode, uint8_t attr);
 void fs_reopen(struct fs_file *file);
 int8_t fs_close(struct fs_file *file);
+/* Hold the file lock across several _fs_read/_fs_write calls */
+void fs_lock(struct fs_file *file);
+void fs_unlock(struct fs_file *file);
+int16_t _fs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
+int16_t _fs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
 int16_t fs_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs);
 int16_t fs_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs);
 int8_t fs_truncate(struct fs_file *file, uint32_t size);
+int8_t fs_fsync(struct fs_file *file);
+int8_t fs_fallocate(struct fs_file *file, uint32_t len);
 int8_t fs_readdir(struct fs_file *dir, struct fs_dentry *dentry, uint16_t idx);
+int16_t fs_getdents(struct fs_file *dir, struct fs_dentry *dentries, uint8_t count, uint16_t *idx);
 int8_t fs_move(struct fs_file *file, struct fs_file *ndir, const char *name);
 int8_t fs_remove(const char *path);
-int8_t fs_ioctl(struct fs_file *file, int16_t op, ...);
+int8_t fs_ioctl(struct fs_file *file, int16_t op, uint8_t flags, ...);
+/* Lockless, callable in the thread critical section */
+uint8_t fs_poll(struct fs_file *file, uint8_t events);
+int8_t fs_statfs(struct fs_file *file, struct statfs *buf);
+/* Flushes dirty files and all mounted filesystems */
+int8_t fs_sync(void);
 int8_t fs_mount(struct fs_ctx *ctx, const struct fs_file_op *op, struct dev_blk *cb, struct fs_file *dir);
 int8_t fs_unmount(struct fs_file *mountpoint);
 void fs_init(void);
@@ -0,0 +1,273 @@
+/* ZAK180 Firmaware
+ * Pipes
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/poll.h>
+
+#include "fs/fs.h"
+#include "fs/pipe.h"
+#include "mem/page.h"
+#include "mem/kmalloc.h"
+#include "proc/lock.h"
+#include "proc/cond.h"
+#include "proc/poll.h"
+#include "lib/errno.h"
+#include "lib/lockstat.h"
+#include "driver/mmu.h"
+#include "driver/dma.h"
+
+/* Ring buffer in a dedicated physical page. Data is moved
+ * with DMA, the other side might be in the scratch window. */
+
+#define PIPE_END_READ  (1 << 0)
+#define PIPE_END_WRITE (1 << 1)
+
+/* Limits time spent with interrupts disabled by a DMA burst */
+#define PIPE_DMA_CHUNK 512
+
+struct pipe {
+	uint8_t page;
+	uint8_t ends;
+	uint16_t rd;
+	uint16_t cnt;
+	struct lock lock;
+	struct thread *rqueue;
+	struct thread *wqueue;
+};
+
+static int16_t pipe_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
+static int16_t pipe_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags);
+static uint8_t pipe_poll(struct fs_file *file, uint8_t events);
+static void pipe_release(struct fs_file *file);
+
+static const struct fs_file_op pipe_op = {
+	.create = NULL,
+	.read = pipe_read,
+	.write = pipe_write,
+	.truncate = NULL,
+	.readdir = NULL,
+	.getdents = NULL,
+	.statfs = NULL,
+	.fsync = NULL,
+	.fallocate = NULL,
+	.sync = NULL,
+	.move = NULL,
+	.remove = NULL,
+	.ioctl = NULL,
+	.poll = pipe_poll,
+	.mount = NULL,
+	.unmount = NULL,
+	.release = pipe_release
+};
+
+static struct {
+	struct fs_ctx ctx;
+	struct lock_stat lstat;
+} common = {
+	.ctx = {
+		.op = &pipe_op,
+		.type = FS_TYPE_PIPE
+	}
+};
+
+/* Copy between the ring (at pos) and a buffer, split on the buffer
+ * page boundaries and the ring end */
+static void pipe_copy(struct pipe *pipe, uint16_t pos, uint8_t *buff, uint16_t len, uint8_t to_ring)
+{
+	while (len) {
+		uint16_t boffs = (uint16_t)buff % PAGE_SIZE;
+		uint16_t chunk = PAGE_SIZE - pos;
+
+		if (chunk > PAGE_SIZE - boffs) {
+			chunk = PAGE_SIZE - boffs;
+		}
+		if (chunk > PIPE_DMA_CHUNK) {
+			chunk = PIPE_DMA_CHUNK;
+		}
+		if (chunk > len) {
+			chunk = len;
+		}
+
+		if (to_ring) {
+			dma_memcpy(pipe->page, pos, mmu_get_page(buff), boffs, chunk);
+		}
+		else {
+			dma_memcpy(mmu_get_page(buff), boffs, pipe->page, pos, chunk);
+		}
+
+		pos = (pos + chunk) % PAGE_SIZE;
+		buff += chunk;
+		len -= chunk;
+	}
+}
+
+static int16_t pipe_read(struct fs_file *file, void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
+{
+	(void)offs;
+
+	struct pipe *pipe = file->file.pipe.pipe;
+
+	if (!bufflen) {
+		return 0;
+	}
+
+	lock_lock(&pipe->lock);
+	while (!pipe->cnt) {
+		if (!(pipe->ends & PIPE_END_WRITE)) {
+			/* EOF */
+			lock_unlock(&pipe->lock);
+			return 0;
+		}
+
+		if (flags & O_NONBLOCK) {
+			lock_unlock(&pipe->lock);
+			return -EAGAIN;
+		}
+
+		(void)cond_wait(&pipe->rqueue, &pipe->lock, 0);
+	}
+
+	uint16_t len = (bufflen < pipe->cnt) ? bufflen : pipe->cnt;
+	pipe_copy(pipe, pipe->rd, buff, len, 0);
+	pipe->rd = (pipe->rd + len) % PAGE_SIZE;
+	pipe->cnt -= len;
+
+	(void)cond_broadcast(&pipe->wqueue);
+	lock_unlock(&pipe->lock);
+
+	poll_notify();
+
+	return len;
+}
+
+static int16_t pipe_write(struct fs_file *file, const void *buff, size_t bufflen, uint32_t offs, uint8_t flags)
+{
+	(void)offs;
+
+	struct pipe *pipe = file->file.pipe.pipe;
+	uint16_t len = 0;
+	int16_t ret = 0;
+
+	lock_lock(&pipe->lock);
+	while (len < bufflen) {
+		if (!(pipe->ends & PIPE_END_READ)) {
+			ret = -EPIPE;
+			break;
+		}
+
+		if (pipe->cnt == PAGE_SIZE) {
+			if (flags & O_NONBLOCK) {
+				ret = -EAGAIN;
+				break;
+			}
+
+			(void)cond_wait(&pipe->wqueue, &pipe->lock, 0);
+			continue;
+		}
+
+		uint16_t chunk = PAGE_SIZE - pipe->cnt;
+		if (chunk > bufflen - len) {
+			chunk = bufflen - len;
+		}
+
+		pipe_copy(pipe, (pipe->rd + pipe->cnt) % PAGE_SIZE, (uint8_t *)buff + len, chunk, 1);
+		pipe->cnt += chunk;
+		len += chunk;
+
+		(void)cond_broadcast(&pipe->rqueue);
+		poll_notify();
+	}
+	lock_unlock(&pipe->lock);
+
+	return (len > 0) ? len : ret;
+}
+
+static uint8_t pipe_poll(struct fs_file *file, uint8_t events)
+{
+	/* Lockless, single byte reads of the state are consistent enough */
+	struct pipe *pipe = file->file.pipe.pipe;
+	uint8_t revents = 0;
+
+	if (file->file.pipe.end == PIPE_END_READ) {
+		if (pipe->cnt) {
+			revents |= POLLIN;
+		}
+		if (!(pipe->ends & PIPE_END_WRITE)) {
+			revents |= POLLIN | POLLHUP;
+		}
+	}
+	else {
+		if (pipe->cnt < PAGE_SIZE) {
+			revents |= POLLOUT;
+		}
+		if (!(pipe->ends & PIPE_END_READ)) {
+			revents |= POLLERR;
+		}
+	}
+
+	return revents & (events | POLLHUP | POLLERR);
+}
+
+static void pipe_release(struct fs_file *file)
+{
+	struct pipe *pipe = file->file.pipe.pipe;
+
+	lock_lock(&pipe->lock);
+	pipe->ends &= ~file->file.pipe.end;
+
+	/* Wake the other end up, it gets EOF or EPIPE */
+	(void)cond_broadcast(&pipe->rqueue);
+	(void)cond_broadcast(&pipe->wqueue);
+	uint8_t ends = pipe->ends;
+	lock_unlock(&pipe->lock);
+
+	poll_notify();
+
+	if (!ends) {
+		page_free(pipe->page, 1);
+		kfree(pipe);
+	}
+}
+
+int8_t pipe_create(struct fs_file **rd, struct fs_file **wr)
+{
+	struct pipe *pipe = kmalloc(sizeof(*pipe));
+	if (pipe == NULL) {
+		return -ENOMEM;
+	}
+
+	memset(pipe, 0, sizeof(*pipe));
+	lock_init(&pipe->lock);
+	lockstat_register(&pipe->lock, &common.lstat, "pipe");
+
+	pipe->page = page_alloc(PAGE_OWNER_KERNEL, 1);
+	if (!pipe->page) {
+		kfree(pipe);
+		return -ENOMEM;
+	}
+
+	*rd = fs_file_anon(&common.ctx, S_IFIFO | S_IR);
+	*wr = fs_file_anon(&common.ctx, S_IFIFO | S_IW);
+	if ((*rd == NULL) || (*wr == NULL)) {
+		kfree(*rd);
+		kfree(*wr);
+		page_free(pipe->page, 1);
+		kfree(pipe);
+		return -ENOMEM;
+	}
+
+	(*rd)->file.pipe.pipe = pipe;
+	(*rd)->file.pipe.end = PIPE_END_READ;
+	(*wr)->file.pipe.pipe = pipe;
+	(*wr)->file.pipe.end = PIPE_END_WRITE;
+	pipe->ends = PIPE_END_READ | PIPE_END_WRITE;
+
+	return 0;
+}
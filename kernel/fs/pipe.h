@@ -0,0 +1,23 @@
+/* ZAK180 Firmaware
+ * Pipes
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef FS_PIPE_H_
+#define FS_PIPE_H_
+
+#include <stdint.h>
+
+struct fs_file;
+struct pipe;
+
+struct pipe_file {
+	struct pipe *pipe;
+	uint8_t end;
+};
+
+/* Creates read and write ends, both are closed with fs_close() */
+int8_t pipe_create(struct fs_file **rd, struct fs_file **wr);
+
+#endif
@@ -12,11 +12,15 @@
 .globl _vga_vblank_handler
 .globl _dev_uart_irq_handler
 .globl _timer_irq_handler
+.globl __prof_sample
 .globl __thread_schedule
 .globl __thread_critical_end
 .globl __thread_reschedule
 .globl __thread_longjmp
 .globl __thread_jmp
+.globl _syscall_enter
+.globl _syscall_exit
+.globl _fsyscall_nosys
 
 .z180
 
@@ -33,6 +37,8 @@ INT2_ACK = 0x0040 ; VBLANK INT2 acknownlage
 TCR =      0x0010 ; PRT control
 TMDR0L =   0x000C ; Timer Data Register Channel 0L
 TMDR0H =   0x000D ; Timer Data Register Channel 0H
+TMDR1L =   0x0014 ; Timer Data Register Channel 1L
+TMDR1H =   0x0015 ; Timer Data Register Channel 1H
 
 ITC =      0x0034 ; INT/TRAP Control Register
 
@@ -92,76 +98,42 @@ reset:
 
 			jp _main
 
+.org 0x0030
+fsyscall:
+			; Register based syscalls entry (rst #30)
+			jp _fsyscall_entry
+
 .org 0x0038
 syscall:
 			; We're using the __sdcccall(0) ABI for syscalls,
 			; all parameters are passed right to left on the
 			; stack, so all we have to do is to simply switch
 			; the memory layout in the MMU, the rest is
-			; handled by the compiler.
+			; handled by the compiler. Dispatch is done from
+			; the _CODE area as there's no room left here.
 
 			pop de ; drop return address from rst #38
-			ld d, #0
 			ld e, a ; sycall number
-			ld hl, #_syscall_table
-			add hl, de
-			add hl, de
-			ld e, (hl)
-			inc hl
-			ld d, (hl)
-			ex de, hl
 
 			; Change memory layout to the kernel one
 			ld a, #0xFE
 			out0 (#CBAR), a
 
-			call jp_hl
+			jp _syscall_dispatch
 
+syscall_return:
 			; Change memory layout to the user space one
 			ld a, #0xF1
 			out0 (#CBAR), a
 
 			ret
 
-jp_hl:
-			jp (hl)
-
-_syscall_table:
-.globl _syscall_fork
-.word  _syscall_fork
-.globl _syscall_waitpid
-.word  _syscall_waitpid
-.globl _syscall_process_end
-.word  _syscall_process_end
-.globl _syscall_msleep
-.word  _syscall_msleep
-.globl _syscall_execv
-.word  _syscall_execv
-.globl _syscall_open
-.word  _syscall_open
-.globl _syscall_close
-.word  _syscall_close
-.globl _syscall_read
-.word  _syscall_read
-.globl _syscall_write
-.word  _syscall_write
-.globl _syscall_truncate
-.word  _syscall_truncate
-.globl _syscall_ftruncate
-.word  _syscall_ftruncate
-.globl _syscall_readdir
-.word  _syscall_readdir
-.globl _syscall_remove
-.word  _syscall_remove
-.globl _syscall_dup2
-.word  _syscall_dup2
-
 .org 0x0100
 ivt:
 .word _irq_bad    ; INT1, floppy IRQ not supported
 .word _irq_vblank ; INT2, VBLANK
 .word _irq_prt0   ; PRT CH0, systick
-.word _irq_bad    ; PRT CH1, not supported
+.word _irq_prt1   ; PRT CH1, profiler
 .word _irq_bad    ; DMA CH0, not supported
 .word _irq_bad    ; DMA CH1, not supported
 .word _irq_bad    ; CSI/O, not supported
@@ -409,6 +381,132 @@ data_init:
 
 .area _CODE
 
+; crt0 _CODE is linked first, so code below is still
+; reachable from the user memory layout (< 0x1000)
+
+; Register based syscalls, __sdcccall(1) ABI:
+; a - syscall number (same as _syscall_table index),
+; hl, de - 1st and 2nd argument, 3rd argument on the stack
+; (removed by the user stub), return value in de (hlde).
+_fsyscall_entry:
+			ld c, a
+
+			; Change memory layout to the kernel one
+			ld a, #0xFE
+			out0 (#CBAR), a
+
+			; ix+2 - rst return, ix+4 - user return, ix+6 - 3rd argument
+			push ix
+			ld ix, #0
+			add ix, sp
+
+			ld a, c
+			cp a, #FSYSCALL_COUNT
+			jr nc, fsyscall_bad
+
+			push de ; 2nd argument, ix-2
+			push hl ; 1st argument, ix-4
+
+			ld b, #0
+			push bc
+
+			; void syscall_enter(uint8_t no [a], const uint16_t *args [de])
+			ld hl, #2
+			add hl, sp
+			ex de, hl
+			call _syscall_enter
+
+			pop bc
+
+			; Handler might remove its stack argument or not,
+			; always pass a copy, sp is restored from ix anyway
+			ld l, 6 (ix)
+			ld h, 7 (ix)
+			push hl
+
+			ld hl, #fsyscall_return
+			push hl
+
+			ld hl, #_fsyscall_table
+			add hl, bc
+			add hl, bc
+			ld a, (hl)
+			inc hl
+			ld h, (hl)
+			ld l, a
+			push hl
+
+			ld l, -4 (ix)
+			ld h, -3 (ix)
+			ld e, -2 (ix)
+			ld d, -1 (ix)
+			ret ; enter the handler
+
+fsyscall_return:
+			; void syscall_exit(int16_t ret [hl]), preserve hlde
+			push hl
+			push de
+			ex de, hl
+			call _syscall_exit
+			pop de
+			pop hl
+
+fsyscall_leave:
+			ld sp, ix
+			pop ix
+
+			; Change memory layout to the user space one
+			ld a, #0xF1
+			out0 (#CBAR), a
+
+			ret
+
+fsyscall_bad:
+			ld de, #-24 ; -ENOSYS
+			jr fsyscall_leave
+
+FSYSCALL_COUNT = 15
+
+_fsyscall_table:
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.globl _fsyscall_msleep
+.word  _fsyscall_msleep
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.globl _fsyscall_read
+.word  _fsyscall_read
+.globl _fsyscall_write
+.word  _fsyscall_write
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.word  _fsyscall_nosys
+.globl _fsyscall_time
+.word  _fsyscall_time
+
+_irq_prt1:
+			SAVE_IRQ
+			; acknowledge irq
+			in0 a, (#TCR)
+			in0 a, (#TMDR1L)
+			in0 a, (#TMDR1H)
+
+			; void _prof_sample(uint8_t layout [a], uint16_t pc [de])
+			ld hl, #6 ; skip layout, iy, ix
+			add hl, sp
+			ld e, (hl)
+			inc hl
+			ld d, (hl)
+			ld hl, #1
+			add hl, sp
+			ld a, (hl)
+			call __prof_sample
+			jp _restore_irq
+
 .globl __bss_end
 
 __bss_end: ; uint16_t _bss_end(void)
@@ -418,3 +516,99 @@ __bss_end: ; uint16_t _bss_end(void)
 			push hl
 			pop de
 			ret
+
+_syscall_dispatch: ; syscall number in e, user stack frame untouched
+			ld d, #0
+			push de
+
+			; void syscall_enter(uint8_t no [a], const uint16_t *args [de])
+			ld a, e
+			ld hl, #4 ; skip syscall number and raddr
+			add hl, sp
+			ex de, hl
+			call _syscall_enter
+
+			pop de
+			ld hl, #_syscall_table
+			add hl, de
+			add hl, de
+			ld e, (hl)
+			inc hl
+			ld d, (hl)
+			ex de, hl
+
+			call jp_hl
+
+			; void syscall_exit(int16_t ret [hl]), preserve dehl
+			push de
+			push hl
+			call _syscall_exit
+			pop hl
+			pop de
+
+			jp syscall_return
+
+jp_hl:
+			jp (hl)
+
+_syscall_table:
+.globl _syscall_fork
+.word  _syscall_fork
+.globl _syscall_waitpid
+.word  _syscall_waitpid
+.globl _syscall_process_end
+.word  _syscall_process_end
+.globl _syscall_msleep
+.word  _syscall_msleep
+.globl _syscall_execv
+.word  _syscall_execv
+.globl _syscall_open
+.word  _syscall_open
+.globl _syscall_close
+.word  _syscall_close
+.globl _syscall_read
+.word  _syscall_read
+.globl _syscall_write
+.word  _syscall_write
+.globl _syscall_truncate
+.word  _syscall_truncate
+.globl _syscall_ftruncate
+.word  _syscall_ftruncate
+.globl _syscall_readdir
+.word  _syscall_readdir
+.globl _syscall_remove
+.word  _syscall_remove
+.globl _syscall_dup2
+.word  _syscall_dup2
+.globl _syscall_time
+.word  _syscall_time
+.globl _syscall_batch
+.word  _syscall_batch
+.globl _syscall_readv
+.word  _syscall_readv
+.globl _syscall_writev
+.word  _syscall_writev
+.globl _syscall_lseek
+.word  _syscall_lseek
+.globl _syscall_pread
+.word  _syscall_pread
+.globl _syscall_pwrite
+.word  _syscall_pwrite
+.globl _syscall_poll
+.word  _syscall_poll
+.globl _syscall_ioctl
+.word  _syscall_ioctl
+.globl _syscall_pipe
+.word  _syscall_pipe
+.globl _syscall_sendfile
+.word  _syscall_sendfile
+.globl _syscall_getdents
+.word  _syscall_getdents
+.globl _syscall_statfs
+.word  _syscall_statfs
+.globl _syscall_sync
+.word  _syscall_sync
+.globl _syscall_fsync
+.word  _syscall_fsync
+.globl _syscall_fallocate
+.word  _syscall_fallocate
@@ -32,5 +32,6 @@
 #define ENOSYS 24
 #define ENAMETOOLONG 25
 #define ETIME 26
+#define EFAULT 27
 
 #endif
@@ -0,0 +1,111 @@
+/* ZAK180 Firmaware
+ * Interrupt latency statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lib/irqlat.h"
+#include "lib/errno.h"
+#include "proc/timer.h"
+#include "fs/devfs.h"
+
+#include "driver/critical.h"
+
+static struct {
+	volatile uint8_t enabled;
+	uint16_t hist[IRQLAT_HIST];
+	uint32_t max;
+} common;
+
+void irqlat_wakeup(uint32_t stamp)
+{
+	if (!common.enabled) {
+		return;
+	}
+
+	critical_start();
+	uint32_t ticks = _timer_stamp() - stamp;
+	uint8_t bucket = 0;
+
+	for (uint32_t t = ticks; (t > 1) && (bucket < IRQLAT_HIST - 1); t >>= 1) {
+		++bucket;
+	}
+	++common.hist[bucket];
+
+	if (ticks > common.max) {
+		common.max = ticks;
+	}
+	critical_end();
+}
+
+static int16_t irqlat_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)flags;
+
+	struct irqlat_report report;
+
+	if (offs >= sizeof(report)) {
+		return 0;
+	}
+
+	if (bufflen > sizeof(report) - offs) {
+		bufflen = sizeof(report) - offs;
+	}
+
+	critical_stat_get(&report.critical);
+
+	critical_start();
+	memcpy(report.wakeup_hist, common.hist, sizeof(report.wakeup_hist));
+	report.wakeup_max = common.max;
+	critical_end();
+
+	memcpy(buff, (uint8_t *)&report + offs, bufflen);
+
+	return bufflen;
+}
+
+static int16_t irqlat_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)offs;
+	(void)flags;
+
+	if (!bufflen) {
+		return 0;
+	}
+
+	/* Non-zero byte resets and starts measurements, zero stops */
+	uint8_t enable = *(const uint8_t *)buff;
+
+	common.enabled = 0;
+	if (enable) {
+		critical_start();
+		memset(common.hist, 0, sizeof(common.hist));
+		common.max = 0;
+		critical_end();
+	}
+	critical_measure(enable);
+	common.enabled = enable;
+
+	return bufflen;
+}
+
+int8_t irqlat_init(struct fs_ctx *devfs)
+{
+	static const struct dev_ops ops = {
+		.read = irqlat_read,
+		.write = irqlat_write,
+		.sync = NULL,
+		.ioctl = NULL,
+		.poll = NULL
+	};
+
+	uint8_t minor;
+	return devfs_register(devfs, "IRQLAT", &minor, &ops, sizeof(struct irqlat_report));
+}
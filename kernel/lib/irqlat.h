@@ -0,0 +1,31 @@
+/* ZAK180 Firmaware
+ * Interrupt latency statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_LIB_IRQLAT_H_
+#define KERNEL_LIB_IRQLAT_H_
+
+#include <stdint.h>
+
+#include "driver/critical.h"
+
+/* IRQ to thread wakeup latency, log2 of PRT0 ticks (TIMER_STAMP_HZ) */
+#define IRQLAT_HIST 16
+
+/* Device content */
+struct irqlat_report {
+	struct critical_stat critical;
+	uint16_t wakeup_hist[IRQLAT_HIST];
+	uint32_t wakeup_max;
+};
+
+struct fs_ctx;
+
+/* Thread woken up by an interrupt at stamp */
+void irqlat_wakeup(uint32_t stamp);
+
+int8_t irqlat_init(struct fs_ctx *devfs);
+
+#endif
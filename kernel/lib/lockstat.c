@@ -0,0 +1,108 @@
+/* ZAK180 Firmaware
+ * Lock contention statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lib/lockstat.h"
+#include "lib/errno.h"
+#include "driver/critical.h"
+#include "fs/devfs.h"
+
+static struct {
+	struct lock_stat *stats;
+} common;
+
+void lockstat_register(struct lock *lock, struct lock_stat *stat, const char *name)
+{
+	/* Might be used before the scheduler is up */
+	critical_start();
+	if (stat->name == NULL) {
+		stat->name = name;
+		stat->next = common.stats;
+		common.stats = stat;
+	}
+	lock->stat = stat;
+	critical_end();
+}
+
+static int16_t lockstat_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)flags;
+
+	struct lockstat_record rec;
+	size_t len = 0;
+	uint8_t idx = offs / sizeof(rec);
+	uint8_t skip = offs % sizeof(rec);
+
+	/* Registered stats are never removed */
+	struct lock_stat *stat = common.stats;
+	for (uint8_t i = 0; (i < idx) && (stat != NULL); ++i) {
+		stat = stat->next;
+	}
+
+	while ((stat != NULL) && (len < bufflen)) {
+		strncpy(rec.name, stat->name, sizeof(rec.name));
+		critical_start();
+		rec.acquired = stat->acquired;
+		rec.contended = stat->contended;
+		rec.wait = stat->wait;
+		rec.wait_max = stat->wait_max;
+		rec.hold_max = stat->hold_max;
+		critical_end();
+
+		size_t chunk = sizeof(rec) - skip;
+		if (chunk > bufflen - len) {
+			chunk = bufflen - len;
+		}
+
+		memcpy((uint8_t *)buff + len, (uint8_t *)&rec + skip, chunk);
+		len += chunk;
+		skip = 0;
+
+		stat = stat->next;
+	}
+
+	return len;
+}
+
+static int16_t lockstat_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)buff;
+	(void)offs;
+	(void)flags;
+
+	/* Any write resets the statistics */
+	for (struct lock_stat *stat = common.stats; stat != NULL; stat = stat->next) {
+		critical_start();
+		stat->acquired = 0;
+		stat->contended = 0;
+		stat->wait = 0;
+		stat->wait_max = 0;
+		stat->hold_max = 0;
+		critical_end();
+	}
+
+	return bufflen;
+}
+
+int8_t lockstat_init(struct fs_ctx *devfs)
+{
+	static const struct dev_ops ops = {
+		.read = lockstat_read,
+		.write = lockstat_write,
+		.sync = NULL,
+		.ioctl = NULL,
+		.poll = NULL
+	};
+
+	uint8_t minor;
+	return devfs_register(devfs, "LOCKSTAT", &minor, &ops, 0);
+}
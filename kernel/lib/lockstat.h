@@ -0,0 +1,34 @@
+/* ZAK180 Firmaware
+ * Lock contention statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_LIB_LOCKSTAT_H_
+#define KERNEL_LIB_LOCKSTAT_H_
+
+#include <stdint.h>
+
+#include "proc/lock.h"
+
+#define LOCKSTAT_NAME_LEN 8
+
+/* Device record */
+struct lockstat_record {
+	char name[LOCKSTAT_NAME_LEN];
+	uint32_t acquired;
+	uint32_t contended;
+	uint32_t wait;
+	uint32_t wait_max;
+	uint32_t hold_max;
+};
+
+struct fs_ctx;
+
+/* Attach statistics to the lock, stat is registered
+ * on the first use, so it can be shared by many locks */
+void lockstat_register(struct lock *lock, struct lock_stat *stat, const char *name);
+
+int8_t lockstat_init(struct fs_ctx *devfs);
+
+#endif
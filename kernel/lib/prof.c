@@ -0,0 +1,209 @@
+/* ZAK180 Firmaware
+ * Statistical PC-sampling profiler
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lib/prof.h"
+#include "lib/errno.h"
+#include "mem/page.h"
+#include "proc/thread.h"
+#include "proc/process.h"
+#include "fs/devfs.h"
+
+#include "driver/mmu.h"
+#include "driver/dma.h"
+#include "driver/vga.h"
+#include "driver/prt.h"
+#include "driver/critical.h"
+
+#define PROF_MODE_OFF     0
+#define PROF_MODE_SYSTICK 1
+#define PROF_MODE_FAST    2
+
+#define PROF_SIZE (2 * PAGE_SIZE)
+
+/* Limits time spent with interrupts disabled during DMA */
+#define PROF_READ_CHUNK 512
+
+static struct {
+	uint8_t page;
+	volatile uint8_t mode;
+	volatile id_t pid;
+} common;
+
+void _prof_sample(uint8_t layout, uint16_t pc)
+{
+	uint8_t page = common.page;
+
+	if (layout != CONTEXT_LAYOUT_KERNEL) {
+		if (common.pid) {
+			struct thread *curr = thread_current();
+			if ((curr == NULL) || (curr->process == NULL) || (curr->process->pid.id != common.pid)) {
+				return;
+			}
+		}
+		++page;
+	}
+
+	uint8_t prev;
+	uint16_t *hist = mmu_map_scratch(page, &prev);
+	uint16_t *bucket = &hist[pc >> PROF_BUCKET_SHIFT];
+
+	if (*bucket != UINT16_MAX) {
+		++(*bucket);
+	}
+
+	(void)mmu_map_scratch(prev, NULL);
+}
+
+void _prof_tick(struct cpu_context *context)
+{
+	if (common.mode == PROF_MODE_SYSTICK) {
+		_prof_sample(context->layout, context->pc);
+	}
+}
+
+static void prof_set_mode(uint8_t mode, uint8_t interval)
+{
+	if (common.mode == PROF_MODE_FAST) {
+		prt1_disable();
+	}
+
+	common.mode = mode;
+
+	if (mode == PROF_MODE_FAST) {
+		prt1_init(interval);
+	}
+}
+
+static void prof_reset(void)
+{
+	/* Stop sampling for the duration, clearing
+	 * 8 KB is too long to be done in a critical section */
+	uint8_t mode = common.mode;
+	common.mode = PROF_MODE_OFF;
+
+	for (uint8_t i = 0; i < 2; ++i) {
+		uint8_t prev;
+		void *hist = mmu_map_scratch(common.page + i, &prev);
+		memset(hist, 0, PAGE_SIZE);
+		(void)mmu_map_scratch(prev, NULL);
+	}
+
+	common.mode = mode;
+}
+
+static int16_t prof_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)flags;
+
+	if (offs >= PROF_SIZE) {
+		return 0;
+	}
+
+	if (bufflen > PROF_SIZE - offs) {
+		bufflen = PROF_SIZE - offs;
+	}
+
+	size_t len = 0;
+
+	while (len < bufflen) {
+		uint8_t *dest = (uint8_t *)buff + len;
+		uint16_t soffs = (offs + len) % PAGE_SIZE;
+		uint16_t doffs = (uint16_t)dest % PAGE_SIZE;
+		size_t chunk = bufflen - len;
+
+		if (chunk > PROF_READ_CHUNK) {
+			chunk = PROF_READ_CHUNK;
+		}
+		if (chunk > PAGE_SIZE - soffs) {
+			chunk = PAGE_SIZE - soffs;
+		}
+		if (chunk > PAGE_SIZE - doffs) {
+			chunk = PAGE_SIZE - doffs;
+		}
+
+		/* Snapshot, sampling might update counters concurrently */
+		dma_memcpy(mmu_get_page(dest), doffs, common.page + (offs + len) / PAGE_SIZE, soffs, chunk);
+
+		len += chunk;
+	}
+
+	return len;
+}
+
+static int16_t prof_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)offs;
+	(void)flags;
+
+	const uint8_t *cmd = buff;
+	uint16_t arg = 0;
+
+	if (!bufflen) {
+		return 0;
+	}
+
+	if (bufflen >= 3) {
+		arg = cmd[1] | ((uint16_t)cmd[2] << 8);
+	}
+
+	switch (cmd[0]) {
+		case PROF_CMD_STOP:
+			prof_set_mode(PROF_MODE_OFF, 0);
+			break;
+
+		case PROF_CMD_SYSTICK:
+			prof_set_mode(PROF_MODE_SYSTICK, 0);
+			break;
+
+		case PROF_CMD_FAST:
+			if (!arg || (arg > 255)) {
+				return -EINVAL;
+			}
+			prof_set_mode(PROF_MODE_FAST, arg);
+			break;
+
+		case PROF_CMD_RESET:
+			prof_reset();
+			break;
+
+		case PROF_CMD_PID:
+			common.pid = arg;
+			break;
+
+		default:
+			return -EINVAL;
+	}
+
+	return bufflen;
+}
+
+int8_t prof_init(struct fs_ctx *devfs)
+{
+	static const struct dev_ops ops = {
+		.read = prof_read,
+		.write = prof_write,
+		.sync = NULL,
+		.ioctl = NULL,
+		.poll = NULL
+	};
+
+	common.page = page_alloc(PAGE_OWNER_KERNEL, 2);
+	if (!common.page) {
+		return -ENOMEM;
+	}
+
+	prof_reset();
+
+	uint8_t minor;
+	return devfs_register(devfs, "PROF", &minor, &ops, PROF_SIZE);
+}
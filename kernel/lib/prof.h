@@ -0,0 +1,37 @@
+/* ZAK180 Firmaware
+ * Statistical PC-sampling profiler
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_LIB_PROF_H_
+#define KERNEL_LIB_PROF_H_
+
+#include <stdint.h>
+
+#include "hal/cpu.h"
+
+/* Histogram of 16-bit saturating counters, one per 32 bytes
+ * of the address space. Device content: kernel histogram
+ * followed by the user space histogram. */
+#define PROF_BUCKET_SHIFT 5
+
+/* Commands written to the device, 1st byte - command,
+ * optional 16-bit little-endian argument follows */
+#define PROF_CMD_STOP    0
+#define PROF_CMD_SYSTICK 1 /* Sample on the systick */
+#define PROF_CMD_FAST    2 /* Sample on PRT1, arg: interval in ms */
+#define PROF_CMD_RESET   3 /* Clear histograms */
+#define PROF_CMD_PID     4 /* Sample user space of one process only, arg: pid (0 - all) */
+
+struct fs_ctx;
+
+/* Called from the PRT1 interrupt */
+void _prof_sample(uint8_t layout, uint16_t pc);
+
+/* Called from the systick interrupt */
+void _prof_tick(struct cpu_context *context);
+
+int8_t prof_init(struct fs_ctx *devfs);
+
+#endif
@@ -0,0 +1,198 @@
+/* ZAK180 Firmaware
+ * Syscall statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "lib/sysstat.h"
+#include "lib/errno.h"
+#include "lib/kprintf.h"
+#include "proc/timer.h"
+#include "proc/thread.h"
+#include "proc/process.h"
+#include "fs/devfs.h"
+
+#include "driver/critical.h"
+
+/* Device content: struct sysstat for every syscall,
+ * followed by struct sysstat_proc of the selected process */
+#define SYSSTAT_GLOBAL_SIZE (SYSCALL_COUNT * sizeof(struct sysstat))
+#define SYSSTAT_SIZE        (SYSSTAT_GLOBAL_SIZE + sizeof(struct sysstat_proc))
+
+static const char *const names[SYSCALL_COUNT] = {
+	"fork", "waitpid", "process_end", "msleep", "execv", "open", "close",
+	"read", "write", "truncate", "ftruncate", "readdir", "remove", "dup2",
+	"time", "batch", "readv", "writev",
+	"lseek", "pread", "pwrite", "poll", "ioctl", "pipe",
+	"sendfile", "getdents", "statfs", "sync", "fsync",
+	"fallocate"
+};
+
+static struct {
+	struct sysstat stats[SYSCALL_COUNT];
+	id_t pid;
+	volatile id_t strace;
+} common;
+
+static uint8_t sysstat_bucket(uint16_t ticks)
+{
+	uint8_t bucket = 0;
+
+	while ((ticks >= 4) && (bucket < SYSSTAT_BUCKETS - 1)) {
+		ticks >>= 2;
+		++bucket;
+	}
+
+	return bucket;
+}
+
+void sysstat_enter(struct thread *thread, const uint16_t *args)
+{
+	if ((common.strace != 0) && (thread->process->pid.id == common.strace)) {
+		kprintf("strace %d: %s(0x%x, 0x%x, 0x%x)\r\n", thread->process->pid.id,
+			names[thread->syscall], args[0], args[1], args[2]);
+	}
+
+	/* Last, skip strace overhead */
+	thread->sysstamp = timer_stamp();
+}
+
+void sysstat_exit(struct thread *thread, int16_t ret)
+{
+	uint32_t delta = timer_stamp() - thread->sysstamp;
+	uint16_t ticks = (delta > UINT16_MAX) ? UINT16_MAX : delta;
+	struct sysstat *stat = &common.stats[thread->syscall];
+	struct sysstat_proc *pstat = &thread->process->sysstat;
+
+	critical_start();
+	++stat->calls;
+	++stat->hist[sysstat_bucket(ticks)];
+	if (ticks > stat->max) {
+		stat->max = ticks;
+	}
+
+	++pstat->calls[thread->syscall];
+	pstat->ticks += ticks;
+
+	/* time returns a stamp, not an error code */
+	if ((ret < 0) && (thread->syscall != SYSCALL_TIME)) {
+		++stat->errors;
+		++pstat->errors;
+	}
+	critical_end();
+
+	if ((common.strace != 0) && (thread->process->pid.id == common.strace)) {
+		uint32_t us = (delta * 1000) / (TIMER_STAMP_HZ / 1000);
+		kprintf("strace %d: %s = %d (%u us)\r\n", thread->process->pid.id,
+			names[thread->syscall], ret, (unsigned)((us > UINT16_MAX) ? UINT16_MAX : us));
+	}
+}
+
+static int16_t sysstat_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)flags;
+
+	if (offs >= SYSSTAT_SIZE) {
+		return 0;
+	}
+
+	if (bufflen > SYSSTAT_SIZE - offs) {
+		bufflen = SYSSTAT_SIZE - offs;
+	}
+
+	size_t len = 0;
+
+	if (offs < SYSSTAT_GLOBAL_SIZE) {
+		len = SYSSTAT_GLOBAL_SIZE - offs;
+		if (len > bufflen) {
+			len = bufflen;
+		}
+
+		critical_start();
+		memcpy(buff, (uint8_t *)common.stats + offs, len);
+		critical_end();
+	}
+
+	if (len < bufflen) {
+		uint8_t *dest = (uint8_t *)buff + len;
+		size_t poffs = offs + len - SYSSTAT_GLOBAL_SIZE;
+		struct process *p = (common.pid > 0) ? process_get(common.pid) : NULL;
+
+		if (p != NULL) {
+			critical_start();
+			memcpy(dest, (uint8_t *)&p->sysstat + poffs, bufflen - len);
+			critical_end();
+			process_put(p);
+		}
+		else {
+			memset(dest, 0, bufflen - len);
+		}
+	}
+
+	return bufflen;
+}
+
+static int16_t sysstat_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)offs;
+	(void)flags;
+
+	const uint8_t *cmd = buff;
+	id_t arg = 0;
+
+	if (!bufflen) {
+		return 0;
+	}
+
+	if (bufflen >= 3) {
+		arg = cmd[1] | ((uint16_t)cmd[2] << 8);
+	}
+
+	switch (cmd[0]) {
+		case SYSSTAT_CMD_RESET:
+			critical_start();
+			memset(common.stats, 0, sizeof(common.stats));
+			critical_end();
+			break;
+
+		case SYSSTAT_CMD_PID:
+		case SYSSTAT_CMD_STRACE:
+			if (arg < 0) {
+				return -EINVAL;
+			}
+
+			if (cmd[0] == SYSSTAT_CMD_PID) {
+				common.pid = arg;
+			}
+			else {
+				common.strace = arg;
+			}
+			break;
+
+		default:
+			return -EINVAL;
+	}
+
+	return bufflen;
+}
+
+int8_t sysstat_init(struct fs_ctx *devfs)
+{
+	static const struct dev_ops ops = {
+		.read = sysstat_read,
+		.write = sysstat_write,
+		.sync = NULL,
+		.ioctl = NULL,
+		.poll = NULL
+	};
+
+	uint8_t minor;
+	return devfs_register(devfs, "SYSSTAT", &minor, &ops, SYSSTAT_SIZE);
+}
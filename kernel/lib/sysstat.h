@@ -0,0 +1,48 @@
+/* ZAK180 Firmaware
+ * Syscall statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_LIB_SYSSTAT_H_
+#define KERNEL_LIB_SYSSTAT_H_
+
+#include <stdint.h>
+
+#include "syscall.h"
+
+/* Latency histogram, log4 of PRT0 ticks (TIMER_STAMP_HZ):
+ * < 4, < 16, < 64, ..., >= 16384 */
+#define SYSSTAT_BUCKETS 8
+
+/* Commands written to the device, 1st byte - command,
+ * 16-bit little-endian argument follows */
+#define SYSSTAT_CMD_RESET  0 /* Clear global statistics */
+#define SYSSTAT_CMD_PID    1 /* Select process to report, arg: pid */
+#define SYSSTAT_CMD_STRACE 2 /* Log syscalls of a process, arg: pid (0 - off) */
+
+/* Accounted on return, process_end and
+ * successful execv are never counted */
+struct sysstat {
+	uint32_t calls;
+	uint16_t errors;
+	uint16_t max;
+	uint16_t hist[SYSSTAT_BUCKETS];
+};
+
+struct sysstat_proc {
+	uint16_t calls[SYSCALL_COUNT];
+	uint16_t errors;
+	uint32_t ticks;
+};
+
+struct thread;
+struct fs_ctx;
+
+void sysstat_enter(struct thread *thread, const uint16_t *args);
+
+void sysstat_exit(struct thread *thread, int16_t ret);
+
+int8_t sysstat_init(struct fs_ctx *devfs);
+
+#endif
@@ -0,0 +1,153 @@
+/* ZAK180 Firmaware
+ * Kernel event trace
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "lib/trace.h"
+#include "lib/errno.h"
+#include "mem/page.h"
+#include "proc/timer.h"
+#include "fs/devfs.h"
+
+#include "driver/mmu.h"
+#include "driver/dma.h"
+#include "driver/vga.h"
+#include "driver/critical.h"
+
+/* Binary ring of trace_records in a dedicated physical page.
+ * Oldest records are overwritten, reading the device drains
+ * the ring, writing sets the enabled categories mask. */
+
+#define TRACE_RECORDS (PAGE_SIZE / sizeof(struct trace_record))
+
+/* Limits time spent with interrupts disabled while draining */
+#define TRACE_DRAIN_MAX 64
+
+static struct {
+	uint8_t page;
+	volatile uint8_t mask;
+	uint16_t head;
+	uint16_t tail;
+} common;
+
+void _trace_event(uint8_t event, uint8_t arg8, uint16_t arg16)
+{
+	if (!(common.mask & (1 << (event >> 4)))) {
+		return;
+	}
+
+	uint8_t prev;
+	struct trace_record *ring = mmu_map_scratch(common.page, &prev);
+	struct trace_record *rec = &ring[common.head];
+
+	rec->stamp = _timer_stamp();
+	rec->event = event;
+	rec->arg8 = arg8;
+	rec->arg16 = arg16;
+
+	(void)mmu_map_scratch(prev, NULL);
+
+	common.head = (common.head + 1) % TRACE_RECORDS;
+	if (common.head == common.tail) {
+		/* Full, drop the oldest one */
+		common.tail = (common.tail + 1) % TRACE_RECORDS;
+	}
+}
+
+void trace_event(uint8_t event, uint8_t arg8, uint16_t arg16)
+{
+	critical_start();
+	_trace_event(event, arg8, arg16);
+	critical_end();
+}
+
+static int16_t trace_read(uint8_t minor, void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)offs;
+	(void)flags;
+
+	size_t len = 0;
+
+	while (bufflen - len >= sizeof(struct trace_record)) {
+		uint16_t n = (bufflen - len) / sizeof(struct trace_record);
+		if (n > TRACE_DRAIN_MAX) {
+			n = TRACE_DRAIN_MAX;
+		}
+
+		/* Destination might be anywhere (even in the scratch window),
+		 * so copy with DMA from the physical page instead of mapping */
+		uint8_t *dest = (uint8_t *)buff + len;
+		uint16_t dlimit = (PAGE_SIZE - ((uint16_t)dest % PAGE_SIZE)) / sizeof(struct trace_record);
+		if (!dlimit) {
+			/* Record would straddle a page boundary, give up */
+			break;
+		}
+		if (n > dlimit) {
+			n = dlimit;
+		}
+
+		critical_start();
+		uint16_t avail = (common.head >= common.tail) ? (common.head - common.tail) :
+			(TRACE_RECORDS - common.tail);
+		if (n > avail) {
+			n = avail;
+		}
+
+		if (n) {
+			_dma_memcpy(mmu_get_page(dest), (uint16_t)dest % PAGE_SIZE, common.page,
+				common.tail * sizeof(struct trace_record), n * sizeof(struct trace_record));
+			_vga_late_irq();
+			common.tail = (common.tail + n) % TRACE_RECORDS;
+		}
+		critical_end();
+
+		if (!n) {
+			break;
+		}
+
+		len += n * sizeof(struct trace_record);
+	}
+
+	return len;
+}
+
+static int16_t trace_write(uint8_t minor, const void *buff, size_t bufflen, off_t offs, uint8_t flags)
+{
+	(void)minor;
+	(void)offs;
+	(void)flags;
+
+	if (!bufflen) {
+		return 0;
+	}
+
+	common.mask = *(const uint8_t *)buff;
+
+	return bufflen;
+}
+
+int8_t trace_init(struct fs_ctx *devfs)
+{
+	static const struct dev_ops ops = {
+		.read = trace_read,
+		.write = trace_write,
+		.sync = NULL,
+		.ioctl = NULL,
+		.poll = NULL
+	};
+
+	common.page = page_alloc(PAGE_OWNER_KERNEL, 1);
+	if (!common.page) {
+		return -ENOMEM;
+	}
+
+	uint8_t minor;
+	return devfs_register(devfs, "TRACE", &minor, &ops, 0);
+}
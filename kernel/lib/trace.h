@@ -0,0 +1,51 @@
+/* ZAK180 Firmaware
+ * Kernel event trace
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_LIB_TRACE_H_
+#define KERNEL_LIB_TRACE_H_
+
+#include <stdint.h>
+
+/* Categories, enabled at runtime by writing
+ * a mask of (1 << category) to the trace device */
+#define TRACE_SCHED   0
+#define TRACE_SYSCALL 1
+#define TRACE_LOCK    2
+#define TRACE_BLK     3
+#define TRACE_IRQ     4
+
+/* Events, category in the high nibble */
+#define TRACE_EV_SCHED      0x00 /* arg8: pid, arg16: thread */
+#define TRACE_EV_SYS_ENTER  0x10 /* arg8: syscall, arg16: 1st argument */
+#define TRACE_EV_SYS_EXIT   0x11 /* arg8: syscall, arg16: return value */
+#define TRACE_EV_LOCK_WAIT  0x20 /* arg16: lock */
+#define TRACE_EV_LOCK_TAKEN 0x21 /* arg16: lock */
+#define TRACE_EV_BLK_READ   0x30 /* arg16: sector */
+#define TRACE_EV_BLK_WRITE  0x31 /* arg16: sector */
+#define TRACE_EV_BLK_DONE   0x32 /* arg8: error, arg16: sector */
+#define TRACE_EV_IRQ        0x40 /* arg8: source */
+
+#define TRACE_IRQ_SYSTICK 0
+#define TRACE_IRQ_UART0   1
+#define TRACE_IRQ_UART1   2
+
+struct trace_record {
+	uint32_t stamp;
+	uint8_t event;
+	uint8_t arg8;
+	uint16_t arg16;
+};
+
+struct fs_ctx;
+
+/* Has to be called with interrupts disabled */
+void _trace_event(uint8_t event, uint8_t arg8, uint16_t arg16);
+
+void trace_event(uint8_t event, uint8_t arg8, uint16_t arg16);
+
+int8_t trace_init(struct fs_ctx *devfs);
+
+#endif
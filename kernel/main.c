@@ -29,6 +29,14 @@
 #include "lib/panic.h"
 #include "lib/errno.h"
 #include "lib/kprintf.h"
+#include "lib/trace.h"
+#include "lib/prof.h"
+#include "lib/sysstat.h"
+#include "lib/lockstat.h"
+#include "lib/irqlat.h"
+
+/* Period of the init thread heartbeat (ms) */
+#define ALIVE_INTERVAL 10000
 
 static struct {
 	struct thread init;
@@ -85,6 +93,28 @@ void init_thread(void *arg)
 		kprintf("uart1: Init failed (%d)\r\n", ret);
 	}
 
+	/* Init debug facilities */
+	ret = trace_init(&common.devfs);
+	if (ret < 0) {
+		kprintf("trace: Init failed (%d)\r\n", ret);
+	}
+	ret = prof_init(&common.devfs);
+	if (ret < 0) {
+		kprintf("prof: Init failed (%d)\r\n", ret);
+	}
+	ret = sysstat_init(&common.devfs);
+	if (ret < 0) {
+		kprintf("sysstat: Init failed (%d)\r\n", ret);
+	}
+	ret = lockstat_init(&common.devfs);
+	if (ret < 0) {
+		kprintf("lockstat: Init failed (%d)\r\n", ret);
+	}
+	ret = irqlat_init(&common.devfs);
+	if (ret < 0) {
+		kprintf("irqlat: Init failed (%d)\r\n", ret);
+	}
+
 	kprintf("kernel: Starting INIT\r\n");
 
 	/* Start init process */
@@ -93,9 +123,18 @@ void init_thread(void *arg)
 
 	floppy_access(0);
 
+	uint16_t elapsed = 0;
 	while (1) {
-		kprintf("alive %u\r\n", (unsigned)timer_get());
-		thread_sleep_relative(10000);
+		thread_sleep_relative(FS_FLUSH_INTERVAL);
+
+		/* Write back metadata deferred by the filesystems */
+		(void)fs_sync();
+
+		elapsed += FS_FLUSH_INTERVAL;
+		if (elapsed >= ALIVE_INTERVAL) {
+			elapsed = 0;
+			kprintf("alive %u\r\n", (unsigned)timer_get());
+		}
 	}
 }
 
@@ -112,6 +151,7 @@ void main(void) __naked
 	timer_init();
 	thread_init();
 	process_init();
+	file_init();
 	fs_init();
 
 	/* Calculate heap area and init kmalloc */
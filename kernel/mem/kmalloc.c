@@ -11,6 +11,7 @@
 
 #include "proc/lock.h"
 #include "lib/panic.h"
+#include "lib/lockstat.h"
 #include "lib/kprintf.h"
 
 #include "kmalloc.h"
@@ -32,9 +33,11 @@ static struct {
 	header_t *heap;
 	header_t *hint;
 	struct lock lock;
+	struct lock_stat lstat;
+	struct kmalloc_shrinker *shrinkers;
 } common;
 
-void *kmalloc(size_t size)
+static void *kmalloc_heap(size_t size)
 {
 	if (!size) {
 		return NULL;
@@ -73,6 +76,24 @@ void *kmalloc(size_t size)
 	return NULL;
 }
 
+void *kmalloc(size_t size)
+{
+	void *ptr = kmalloc_heap(size);
+
+	if ((ptr == NULL) && size) {
+		uint8_t freed = 0;
+		for (struct kmalloc_shrinker *s = common.shrinkers; s != NULL; s = s->next) {
+			freed |= s->shrink();
+		}
+
+		if (freed) {
+			ptr = kmalloc_heap(size);
+		}
+	}
+
+	return ptr;
+}
+
 void *krealloc(void *ptr, size_t size)
 {
 	if (!size) {
@@ -213,6 +234,14 @@ void kmalloc_stat(size_t *used, size_t *free)
 	}
 }
 
+void kmalloc_shrinker_register(struct kmalloc_shrinker *shrinker)
+{
+	lock_lock(&common.lock);
+	shrinker->next = common.shrinkers;
+	common.shrinkers = shrinker;
+	lock_unlock(&common.lock);
+}
+
 void kalloc_init(void *buff, size_t size)
 {
 	uintptr_t aligned = ALIGN((uintptr_t)buff);
@@ -223,6 +252,7 @@ void kalloc_init(void *buff, size_t size)
 	common.heap->next = NULL;
 	common.hint = common.heap;
 	lock_init(&common.lock);
+	lockstat_register(&common.lock, &common.lstat, "kmalloc");
 
 	_kprintf("kmalloc: init heap 0x%x -> 0x%x\r\n", common.heap, (uint8_t *)common.heap + size - 1);
 }
@@ -9,6 +9,17 @@
 #define KERNEL_KMALLOC_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
+/* Cache that gives memory back when kmalloc runs out of it */
+struct kmalloc_shrinker {
+	struct kmalloc_shrinker *next;
+
+	/* Returns non-zero if anything was freed. Called without
+	 * kmalloc lock, but possibly with any other lock held by
+	 * the allocating thread - must not wait on locks (lock_try). */
+	uint8_t (*shrink)(void);
+};
 
 void *kmalloc(size_t size);
 
@@ -18,6 +29,8 @@ void kfree(void *ptr);
 
 void kmalloc_stat(size_t *used, size_t *free);
 
+void kmalloc_shrinker_register(struct kmalloc_shrinker *shrinker);
+
 void kalloc_init(void *buff, size_t size);
 
 #endif
@@ -9,6 +9,7 @@
 #include "mem/page.h"
 #include "proc/lock.h"
 #include "lib/assert.h"
+#include "lib/lockstat.h"
 #include "lib/kprintf.h"
 
 struct page_element {
@@ -26,6 +27,7 @@ static struct {
 	struct page_element *alloc;
 	struct page_element *cache;
 	struct lock lock;
+	struct lock_stat lstat;
 } common;
 
 static struct page_element *page_element_alloc(void)
@@ -238,4 +240,5 @@ void page_init(uint8_t start, uint8_t pages)
 	page_element_attach(&common.free, element);
 
 	lock_init(&common.lock);
+	lockstat_register(&common.lock, &common.lstat, "page");
 }
@@ -0,0 +1,143 @@
+/* ZAK180 Firmaware
+ * User space memory access
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mem/uaccess.h"
+#include "mem/kmalloc.h"
+#include "proc/thread.h"
+#include "proc/process.h"
+#include "lib/errno.h"
+#include "lib/assert.h"
+
+#include "driver/mmu.h"
+
+#define USTACK_START 0xF000
+
+void *uaccess_map(const void *uaddr, size_t *len, uint8_t *prev)
+{
+	uint16_t addr = (uint16_t)uaddr;
+	uint16_t avail;
+	void *kaddr;
+
+	if (addr < PROCESS_MEM_START) {
+		return NULL;
+	}
+
+	if (addr >= USTACK_START) {
+		/* Stack page is mapped the same way in both layouts */
+		avail = 0 - addr;
+		kaddr = (void *)uaddr;
+		*prev = 0;
+	}
+	else {
+		struct process *process = thread_current()->process;
+		assert(process != NULL);
+
+		uint16_t offs = addr % PAGE_SIZE;
+		uint8_t page = process->mpage + ((addr - PROCESS_MEM_START) / PAGE_SIZE);
+
+		avail = PAGE_SIZE - offs;
+		kaddr = (uint8_t *)mmu_map_scratch(page, prev) + offs;
+	}
+
+	if (*len > avail) {
+		*len = avail;
+	}
+
+	return kaddr;
+}
+
+void uaccess_unmap(uint8_t prev)
+{
+	if (prev) {
+		(void)mmu_map_scratch(prev, NULL);
+	}
+}
+
+int8_t copyin(void *dst, const void *usrc, size_t len)
+{
+	while (len) {
+		uint8_t prev;
+		size_t chunk = len;
+		const void *src = uaccess_map(usrc, &chunk, &prev);
+		if (src == NULL) {
+			return -EFAULT;
+		}
+
+		memcpy(dst, src, chunk);
+		uaccess_unmap(prev);
+
+		dst = (uint8_t *)dst + chunk;
+		usrc = (const uint8_t *)usrc + chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+int8_t copyout(void *udst, const void *src, size_t len)
+{
+	while (len) {
+		uint8_t prev;
+		size_t chunk = len;
+		void *dst = uaccess_map(udst, &chunk, &prev);
+		if (dst == NULL) {
+			return -EFAULT;
+		}
+
+		memcpy(dst, src, chunk);
+		uaccess_unmap(prev);
+
+		udst = (uint8_t *)udst + chunk;
+		src = (const uint8_t *)src + chunk;
+		len -= chunk;
+	}
+
+	return 0;
+}
+
+int8_t strdup_user(char **dst, const char *usrc)
+{
+	size_t len = 0;
+	uint8_t found = 0;
+
+	/* Find the terminator page by page */
+	while (!found) {
+		uint8_t prev;
+		size_t chunk = UACCESS_STR_MAX - len;
+		const char *src = uaccess_map(usrc + len, &chunk, &prev);
+		if (src == NULL) {
+			return -EFAULT;
+		}
+
+		for (size_t i = 0; i < chunk; ++i, ++len) {
+			if (src[i] == '\0') {
+				found = 1;
+				break;
+			}
+		}
+		uaccess_unmap(prev);
+
+		if (!found && (len == UACCESS_STR_MAX)) {
+			return -ENAMETOOLONG;
+		}
+	}
+
+	*dst = kmalloc(len + 1);
+	if (*dst == NULL) {
+		return -ENOMEM;
+	}
+
+	int8_t err = copyin(*dst, usrc, len + 1);
+	if (err < 0) {
+		kfree(*dst);
+	}
+
+	return err;
+}
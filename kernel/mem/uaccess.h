@@ -0,0 +1,34 @@
+/* ZAK180 Firmaware
+ * User space memory access
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_UACCESS_H_
+#define KERNEL_UACCESS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Valid only in a syscall context of the current process.
+ * User addresses are 0x1000 -> 0xEFFF (process memory,
+ * translated via mpage) and 0xF000 -> 0xFFFF (stack). */
+
+/* Longest string accepted from the user space (with NUL) */
+#define UACCESS_STR_MAX 256
+
+/* Make user memory accessible, returns kernel pointer to uaddr or NULL
+ * on a bad address. len is limited to the accessible part. The scratch
+ * window might be used, pass prev to uaccess_unmap() when done. */
+void *uaccess_map(const void *uaddr, size_t *len, uint8_t *prev);
+
+void uaccess_unmap(uint8_t prev);
+
+int8_t copyin(void *dst, const void *usrc, size_t len);
+
+int8_t copyout(void *udst, const void *src, size_t len);
+
+/* Copies user string to a new kmalloc'ed buffer */
+int8_t strdup_user(char **dst, const char *usrc);
+
+#endif
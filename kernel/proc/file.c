@@ -9,14 +9,32 @@
 #include "proc/thread.h"
 #include "proc/process.h"
 #include "proc/file.h"
+#include "proc/poll.h"
+#include "proc/timer.h"
 #include "mem/kmalloc.h"
+#include "mem/page.h"
+#include "mem/uaccess.h"
+#include "fs/pipe.h"
 #include "lib/assert.h"
 #include "lib/errno.h"
+#include "lib/lockstat.h"
+#include "driver/mmu.h"
 
 #define NELEMS(x) (sizeof(x) / sizeof(*x))
 
+/* Batch entries copied in at once (kept on the kernel stack) */
+#define FILE_BATCH_CHUNK 8
+
+/* writev gathers short segments before passing them to the fs */
+#define FILE_GATHER_SIZE 128
+
+/* getdents entries per fs call (a FAT sector worth) */
+#define FILE_DENTS_CHUNK 16
+
 static struct {
 	struct lock lock;
+	struct lock_stat lstat;
+	struct lock_stat olstat;
 } common;
 
 static struct file_open *file_fd_resolve(int8_t fd, uint8_t *flags)
@@ -24,7 +42,7 @@ static struct file_open *file_fd_resolve(int8_t fd, uint8_t *flags)
 	struct process *process = thread_current()->process;
 	assert(process != NULL);
 
-	if (fd < 0 || fd > NELEMS(process->fdtable)) {
+	if (fd < 0 || fd >= NELEMS(process->fdtable)) {
 		return NULL;
 	}
 
@@ -76,18 +94,46 @@ void file_fdtable_copy(struct process *parent, struct process *child)
 	lock_unlock(&common.lock);
 }
 
-int8_t file_open(const char *path, uint8_t mode, uint8_t attr)
+static struct file_open *file_ofile_alloc(void)
 {
 	struct file_open *ofile = kmalloc(sizeof(struct file_open));
+	if (ofile != NULL) {
+		ofile->refs = 1;
+		ofile->offset = 0;
+		lock_init(&ofile->lock);
+		lockstat_register(&ofile->lock, &common.olstat, "ofile");
+	}
+	return ofile;
+}
+
+/* Caller holds common.lock and process->lock */
+static int8_t _file_fd_alloc(struct process *process, int8_t from)
+{
+	for (int8_t fd = from; fd < NELEMS(process->fdtable); ++fd) {
+		if (process->fdtable[fd].ofile == NULL) {
+			return fd;
+		}
+	}
+
+	return -ENFILE;
+}
+
+int8_t file_open(const char *upath, uint8_t mode, uint8_t attr)
+{
+	char *path;
+	int8_t err = strdup_user(&path, upath);
+	if (err < 0) {
+		return err;
+	}
+
+	struct file_open *ofile = file_ofile_alloc();
 	if (ofile == NULL) {
+		kfree(path);
 		return -ENOMEM;
 	}
 
-	ofile->refs = 1;
-	ofile->offset = 0;
-	lock_init(&ofile->lock);
-
-	int8_t err = fs_open(path, &ofile->file, mode, attr);
+	err = fs_open(path, &ofile->file, mode, attr);
+	kfree(path);
 	if (err != 0) {
 		kfree(ofile);
 		return err;
@@ -114,23 +160,80 @@ int8_t file_open(const char *path, uint8_t mode, uint8_t attr)
 	lock_lock(&common.lock);
 	lock_lock(&process->lock);
 
-	for (int8_t fd = 0; fd < NELEMS(process->fdtable); ++fd) {
-		if (process->fdtable[fd].ofile == NULL) {
-			process->fdtable[fd].ofile = ofile;
-			process->fdtable[fd].flags = mode;
-			lock_unlock(&process->lock);
-			lock_unlock(&common.lock);
-			return fd;
-		}
+	int8_t fd = _file_fd_alloc(process, 0);
+	if (fd >= 0) {
+		process->fdtable[fd].ofile = ofile;
+		process->fdtable[fd].flags = mode;
 	}
 
 	lock_unlock(&process->lock);
 	lock_unlock(&common.lock);
 
-	fs_close(ofile->file);
-	kfree(ofile);
+	if (fd < 0) {
+		fs_close(ofile->file);
+		kfree(ofile);
+	}
+
+	return fd;
+}
 
-	return -ENFILE;
+int8_t file_pipe(int8_t *ufds)
+{
+	struct process *process = thread_current()->process;
+	assert(process != NULL);
+
+	struct file_open *ofiles[2];
+	struct fs_file *rd, *wr;
+	int8_t fds[2];
+
+	int8_t err = pipe_create(&rd, &wr);
+	if (err < 0) {
+		return err;
+	}
+
+	ofiles[0] = file_ofile_alloc();
+	ofiles[1] = file_ofile_alloc();
+	if ((ofiles[0] == NULL) || (ofiles[1] == NULL)) {
+		kfree(ofiles[0]);
+		kfree(ofiles[1]);
+		fs_close(rd);
+		fs_close(wr);
+		return -ENOMEM;
+	}
+
+	ofiles[0]->file = rd;
+	ofiles[1]->file = wr;
+
+	lock_lock(&common.lock);
+	lock_lock(&process->lock);
+
+	fds[0] = _file_fd_alloc(process, 0);
+	fds[1] = (fds[0] < 0) ? fds[0] : _file_fd_alloc(process, fds[0] + 1);
+	if (fds[1] >= 0) {
+		process->fdtable[fds[0]].ofile = ofiles[0];
+		process->fdtable[fds[0]].flags = O_RDONLY;
+		process->fdtable[fds[1]].ofile = ofiles[1];
+		process->fdtable[fds[1]].flags = O_WRONLY;
+	}
+
+	lock_unlock(&process->lock);
+	lock_unlock(&common.lock);
+
+	if (fds[1] < 0) {
+		fs_close(rd);
+		fs_close(wr);
+		kfree(ofiles[0]);
+		kfree(ofiles[1]);
+		return fds[1];
+	}
+
+	err = copyout(ufds, fds, sizeof(fds));
+	if (err < 0) {
+		(void)file_close(fds[0]);
+		(void)file_close(fds[1]);
+	}
+
+	return err;
 }
 
 static int8_t _file_close_one(struct process *process, int8_t fd)
@@ -207,6 +310,49 @@ int8_t file_dup2(int8_t oldfd, int8_t newfd)
 	return newfd;
 }
 
+/* Transfer directly from/to user memory, page by page, at *offs.
+ * Caller holds the fs_file lock (and ofile->lock if offs is ofile's). */
+static int16_t _file_rw(struct file_open *ofile, void *ubuff, size_t bufflen, off_t *offs, uint8_t write, uint8_t flags)
+{
+	size_t len = 0;
+	int16_t ret = 0;
+
+	if (bufflen > INT16_MAX) {
+		bufflen = INT16_MAX;
+	}
+
+	while (len < bufflen) {
+		uint8_t prev;
+		size_t chunk = bufflen - len;
+		void *buff = uaccess_map((uint8_t *)ubuff + len, &chunk, &prev);
+		if (buff == NULL) {
+			ret = -EFAULT;
+			break;
+		}
+
+		if (write) {
+			ret = _fs_write(ofile->file, buff, chunk, *offs, flags);
+		}
+		else {
+			ret = _fs_read(ofile->file, buff, chunk, *offs, flags);
+		}
+		uaccess_unmap(prev);
+
+		if (ret <= 0) {
+			break;
+		}
+
+		*offs += ret;
+		len += ret;
+
+		if (ret < chunk) {
+			break;
+		}
+	}
+
+	return (len > 0) ? len : ret;
+}
+
 int16_t file_read(int8_t fd, void *buff, size_t bufflen)
 {
 	uint8_t flags;
@@ -221,10 +367,9 @@ int16_t file_read(int8_t fd, void *buff, size_t bufflen)
 	}
 
 	lock_lock(&ofile->lock);
-	int16_t ret = fs_read(ofile->file, buff, bufflen, ofile->offset);
-	if (ret > 0) {
-		ofile->offset += ret;
-	}
+	fs_lock(ofile->file);
+	int16_t ret = _file_rw(ofile, buff, bufflen, &ofile->offset, 0, flags);
+	fs_unlock(ofile->file);
 	lock_unlock(&ofile->lock);
 
 	file_file_put(ofile);
@@ -246,21 +391,477 @@ int16_t file_write(int8_t fd, const void *buff, size_t bufflen)
 	}
 
 	lock_lock(&ofile->lock);
-	int16_t ret = fs_write(ofile->file, buff, bufflen, ofile->offset);
-	if (ret > 0) {
-		ofile->offset += ret;
+	fs_lock(ofile->file);
+	int16_t ret = _file_rw(ofile, (void *)buff, bufflen, &ofile->offset, 1, flags);
+	fs_unlock(ofile->file);
+	lock_unlock(&ofile->lock);
+
+	file_file_put(ofile);
+
+	return ret;
+}
+
+/* Positional, ofile->offset is neither used nor updated,
+ * so ofile->lock is not taken */
+int16_t file_prw(int8_t fd, void *buff, size_t bufflen, off_t offs, uint8_t write)
+{
+	if (offs < 0) {
+		return -EINVAL;
+	}
+
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	if (flags & (write ? O_RDONLY : O_WRONLY)) {
+		file_file_put(ofile);
+		return -EINVAL;
+	}
+
+	if (!S_ISREG(ofile->file->attr)) {
+		file_file_put(ofile);
+		return -ESPIPE;
 	}
+
+	fs_lock(ofile->file);
+	int16_t ret = _file_rw(ofile, buff, bufflen, &offs, write, flags);
+	fs_unlock(ofile->file);
+
+	file_file_put(ofile);
+
+	return ret;
+}
+
+int8_t file_lseek(int8_t fd, off_t *uoffs, int8_t whence)
+{
+	off_t offs;
+	int8_t ret = copyin(&offs, uoffs, sizeof(offs));
+	if (ret < 0) {
+		return ret;
+	}
+
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	if (!S_ISREG(ofile->file->attr)) {
+		file_file_put(ofile);
+		return -ESPIPE;
+	}
+
+	lock_lock(&ofile->lock);
+
+	switch (whence) {
+		case SEEK_SET:
+			break;
+
+		case SEEK_CUR:
+			offs += ofile->offset;
+			break;
+
+		case SEEK_END:
+			offs += ofile->file->size;
+			break;
+
+		default:
+			offs = -1;
+			break;
+	}
+
+	if (offs >= 0) {
+		/* Seeking past the end is fine, the gap is filled on write */
+		ofile->offset = offs;
+	}
+	else {
+		ret = -EINVAL;
+	}
+
 	lock_unlock(&ofile->lock);
 
 	file_file_put(ofile);
 
+	if (ret == 0) {
+		ret = copyout(uoffs, &offs, sizeof(offs));
+	}
+
 	return ret;
 }
 
-int8_t file_truncate(const char *path, off_t size)
+/* Caller holds ofile->lock and the fs_file lock */
+static int16_t _file_readv(struct file_open *ofile, const struct iovec *iov, uint8_t iovcnt, uint8_t flags)
+{
+	int16_t total = 0, ret = 0;
+
+	for (uint8_t i = 0; i < iovcnt; ++i) {
+		if (!iov[i].iov_len) {
+			continue;
+		}
+
+		ret = _file_rw(ofile, iov[i].iov_base, iov[i].iov_len, &ofile->offset, 0, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		/* Short read (or EOF) ends it */
+		total += ret;
+		if (ret < iov[i].iov_len) {
+			break;
+		}
+	}
+
+	return (total > 0) ? total : ret;
+}
+
+/* Short segments are copied into one buffer, so e.g. a prompt
+ * and a line reach the device in a single write.
+ * Caller holds ofile->lock and the fs_file lock. */
+static int16_t _file_writev(struct file_open *ofile, const struct iovec *iov, uint8_t iovcnt, uint8_t flags)
 {
+	uint8_t gather[FILE_GATHER_SIZE];
+	size_t glen = 0;
+	int16_t total = 0, ret = 0;
+	uint8_t i = 0;
+
+	while (ret >= 0) {
+		if ((i < iovcnt) && (iov[i].iov_len <= sizeof(gather) - glen)) {
+			ret = copyin(gather + glen, iov[i].iov_base, iov[i].iov_len);
+			if (ret >= 0) {
+				glen += iov[i].iov_len;
+				++i;
+			}
+			continue;
+		}
+
+		if (glen) {
+			size_t wlen = glen;
+			glen = 0;
+			ret = _fs_write(ofile->file, gather, wlen, ofile->offset, flags);
+			if (ret > 0) {
+				ofile->offset += ret;
+				total += ret;
+			}
+			if (ret < (int16_t)wlen) {
+				break;
+			}
+		}
+
+		if (i >= iovcnt) {
+			break;
+		}
+
+		if (iov[i].iov_len > sizeof(gather)) {
+			ret = _file_rw(ofile, iov[i].iov_base, iov[i].iov_len, &ofile->offset, 1, flags);
+			if (ret > 0) {
+				total += ret;
+			}
+			if (ret < (int16_t)iov[i].iov_len) {
+				break;
+			}
+			++i;
+		}
+	}
+
+	/* Flush what was gathered before a failed copyin */
+	if (glen && (ret < 0)) {
+		int16_t err = _fs_write(ofile->file, gather, glen, ofile->offset, flags);
+		if (err > 0) {
+			ofile->offset += err;
+			total += err;
+		}
+	}
+
+	return (total > 0) ? total : ret;
+}
+
+int16_t file_rwv(int8_t fd, const struct iovec *uiov, uint8_t iovcnt, uint8_t write)
+{
+	struct iovec iov[IOV_MAX];
+
+	if (iovcnt > IOV_MAX) {
+		return -EINVAL;
+	}
+
+	int8_t err = copyin(iov, uiov, iovcnt * sizeof(*iov));
+	if (err < 0) {
+		return err;
+	}
+
+	/* Whole transfer has to be representable in the return value */
+	uint16_t sum = 0;
+	for (uint8_t i = 0; i < iovcnt; ++i) {
+		if (iov[i].iov_len > INT16_MAX - sum) {
+			return -EINVAL;
+		}
+		sum += iov[i].iov_len;
+	}
+
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	if ((flags & (write ? O_RDONLY : O_WRONLY)) || S_ISDIR(ofile->file->attr)) {
+		file_file_put(ofile);
+		return -EINVAL;
+	}
+
+	lock_lock(&ofile->lock);
+	fs_lock(ofile->file);
+	int16_t ret = write ? _file_writev(ofile, iov, iovcnt, flags) : _file_readv(ofile, iov, iovcnt, flags);
+	fs_unlock(ofile->file);
+	lock_unlock(&ofile->lock);
+
+	file_file_put(ofile);
+
+	return ret;
+}
+
+/* Streams through a kernel page mapped in the scratch window,
+ * the data never crosses into the user space. Input and output
+ * are locked in turns, never both at once. */
+int16_t file_sendfile(int8_t outfd, int8_t infd, off_t *uoffs, size_t count)
+{
+	off_t offs;
+	int16_t ret = 0;
+
+	if (uoffs != NULL) {
+		ret = copyin(&offs, uoffs, sizeof(offs));
+		if (ret < 0) {
+			return ret;
+		}
+		if (offs < 0) {
+			return -EINVAL;
+		}
+	}
+
+	uint8_t inflags, outflags;
+	struct file_open *in = file_fd_resolve(infd, &inflags);
+	if (in == NULL) {
+		return -EBADF;
+	}
+
+	struct file_open *out = file_fd_resolve(outfd, &outflags);
+	if (out == NULL) {
+		file_file_put(in);
+		return -EBADF;
+	}
+
+	if ((inflags & O_WRONLY) || !S_ISREG(in->file->attr) ||
+			(outflags & O_RDONLY) || S_ISDIR(out->file->attr)) {
+		file_file_put(out);
+		file_file_put(in);
+		return -EINVAL;
+	}
+
+	uint8_t page = page_alloc(PAGE_OWNER_KERNEL, 1);
+	if (!page) {
+		file_file_put(out);
+		file_file_put(in);
+		return -ENOMEM;
+	}
+
+	uint8_t prev;
+	void *buff = mmu_map_scratch(page, &prev);
+	off_t *inoffs = (uoffs != NULL) ? &offs : &in->offset;
+	size_t total = 0;
+
+	if (count > INT16_MAX) {
+		count = INT16_MAX;
+	}
+
+	while (total < count) {
+		size_t chunk = count - total;
+		if (chunk > PAGE_SIZE) {
+			chunk = PAGE_SIZE;
+		}
+
+		if (uoffs == NULL) {
+			lock_lock(&in->lock);
+		}
+		fs_lock(in->file);
+		int16_t rlen = _fs_read(in->file, buff, chunk, *inoffs, inflags);
+		fs_unlock(in->file);
+		if (rlen > 0) {
+			*inoffs += rlen;
+		}
+		if (uoffs == NULL) {
+			lock_unlock(&in->lock);
+		}
+
+		if (rlen <= 0) {
+			ret = rlen;
+			break;
+		}
+
+		lock_lock(&out->lock);
+		fs_lock(out->file);
+		ret = _fs_write(out->file, buff, rlen, out->offset, outflags);
+		fs_unlock(out->file);
+		if (ret > 0) {
+			out->offset += ret;
+			total += ret;
+		}
+		lock_unlock(&out->lock);
+
+		if (ret < rlen) {
+			/* Leave the input at the first byte not sent */
+			int16_t unsent = rlen - ((ret > 0) ? ret : 0);
+			if (uoffs == NULL) {
+				lock_lock(&in->lock);
+			}
+			*inoffs -= unsent;
+			if (uoffs == NULL) {
+				lock_unlock(&in->lock);
+			}
+			break;
+		}
+
+		if (rlen < chunk) {
+			break;
+		}
+	}
+
+	(void)mmu_map_scratch(prev, NULL);
+	page_free(page, 1);
+
+	file_file_put(out);
+	file_file_put(in);
+
+	if (uoffs != NULL) {
+		int8_t err = copyout(uoffs, &offs, sizeof(offs));
+		if (err < 0 && !total) {
+			return err;
+		}
+	}
+
+	return (total > 0) ? total : ret;
+}
+
+static uint8_t _file_poll_scan(struct file_open **ofiles, struct pollfd *fds, uint8_t nfds)
+{
+	uint8_t ready = 0;
+
+	for (uint8_t i = 0; i < nfds; ++i) {
+		if (fds[i].fd < 0) {
+			/* Ignored entry */
+			fds[i].revents = 0;
+			continue;
+		}
+
+		if (ofiles[i] == NULL) {
+			fds[i].revents = POLLNVAL;
+		}
+		else {
+			fds[i].revents = fs_poll(ofiles[i]->file, fds[i].events);
+		}
+
+		if (fds[i].revents) {
+			++ready;
+		}
+	}
+
+	return ready;
+}
+
+int16_t file_poll(struct pollfd *ufds, uint8_t nfds, int16_t timeout)
+{
+	struct pollfd fds[POLL_FDS_MAX];
+	struct file_open *ofiles[POLL_FDS_MAX];
+
+	if (nfds > POLL_FDS_MAX) {
+		return -EINVAL;
+	}
+
+	int8_t err = copyin(fds, ufds, nfds * sizeof(*fds));
+	if (err < 0) {
+		return err;
+	}
+
+	for (uint8_t i = 0; i < nfds; ++i) {
+		uint8_t flags;
+		ofiles[i] = (fds[i].fd < 0) ? NULL : file_fd_resolve(fds[i].fd, &flags);
+	}
+
+	time_t wakeup = (timeout > 0) ? (timer_get() + timeout) : 0;
+	uint8_t ready, expired = 0;
+
+	thread_critical_start();
+	while (1) {
+		ready = _file_poll_scan(ofiles, fds, nfds);
+		if (ready || !timeout || expired) {
+			break;
+		}
+
+		/* Every readiness change wakes all pollers, scan again */
+		if (_poll_wait(wakeup) == -ETIME) {
+			expired = 1;
+		}
+	}
+	thread_critical_end();
+
+	for (uint8_t i = 0; i < nfds; ++i) {
+		if (ofiles[i] != NULL) {
+			file_file_put(ofiles[i]);
+		}
+	}
+
+	err = copyout(ufds, fds, nfds * sizeof(*fds));
+	if (err < 0) {
+		return err;
+	}
+
+	return ready;
+}
+
+int8_t file_ioctl(int8_t fd, int16_t op, void *uarg)
+{
+	uint8_t arg[IOC_SIZE_MAX];
+	uint8_t size = IOC_SIZE(op);
+	int8_t ret;
+
+	if (IOC_DIR(op) & IOC_IN) {
+		ret = copyin(arg, uarg, size);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	ret = fs_ioctl(ofile->file, op, flags, (void *)arg);
+
+	file_file_put(ofile);
+
+	if ((ret >= 0) && (IOC_DIR(op) & IOC_OUT)) {
+		int8_t err = copyout(uarg, arg, size);
+		if (err < 0) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
+int8_t file_truncate(const char *upath, off_t size)
+{
+	char *path;
+	int8_t ret = strdup_user(&path, upath);
+	if (ret < 0) {
+		return ret;
+	}
+
 	struct fs_file *file;
-	int8_t ret = fs_open(path, &file, O_WRONLY, 0);
+	ret = fs_open(path, &file, O_WRONLY, 0);
+	kfree(path);
 	if (ret < 0) {
 		return ret;
 	}
@@ -271,6 +872,32 @@ int8_t file_truncate(const char *path, off_t size)
 	return ret;
 }
 
+int8_t file_statfs(const char *upath, struct statfs *ubuf)
+{
+	char *path;
+	int8_t ret = strdup_user(&path, upath);
+	if (ret < 0) {
+		return ret;
+	}
+
+	struct fs_file *file;
+	ret = fs_open(path, &file, O_RDONLY, 0);
+	kfree(path);
+	if (ret < 0) {
+		return ret;
+	}
+
+	struct statfs buf;
+	ret = fs_statfs(file, &buf);
+	fs_close(file);
+
+	if (ret == 0) {
+		ret = copyout(ubuf, &buf, sizeof(buf));
+	}
+
+	return ret;
+}
+
 int8_t file_ftruncate(int8_t fd, off_t size)
 {
 	uint8_t flags;
@@ -296,6 +923,46 @@ int8_t file_ftruncate(int8_t fd, off_t size)
 	return ret;
 }
 
+int8_t file_fsync(int8_t fd)
+{
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	int8_t ret = fs_fsync(ofile->file);
+
+	file_file_put(ofile);
+
+	return ret;
+}
+
+int8_t file_fallocate(int8_t fd, off_t len)
+{
+	if (len < 0) {
+		return -EINVAL;
+	}
+
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(fd, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	int8_t ret;
+	if ((flags & O_RDONLY) || !S_ISREG(ofile->file->attr)) {
+		ret = -EINVAL;
+	}
+	else {
+		ret = fs_fallocate(ofile->file, len);
+	}
+
+	file_file_put(ofile);
+
+	return ret;
+}
+
 int8_t file_readdir(int8_t dir, struct fs_dentry *dentry, uint16_t idx)
 {
 	uint8_t flags;
@@ -309,14 +976,152 @@ int8_t file_readdir(int8_t dir, struct fs_dentry *dentry, uint16_t idx)
 		return -EINVAL;
 	}
 
-	int16_t ret = fs_readdir(ofile->file, dentry, idx);
+	struct fs_dentry kdentry;
+	int16_t ret = fs_readdir(ofile->file, &kdentry, idx);
+	if (ret >= 0) {
+		int8_t err = copyout(dentry, &kdentry, sizeof(kdentry));
+		if (err < 0) {
+			ret = err;
+		}
+	}
 
 	file_file_put(ofile);
 
 	return ret;
 }
 
-int8_t file_remove(const char *path)
+/* Directory position (entry index) is kept in ofile->offset */
+int16_t file_getdents(int8_t dir, struct fs_dentry *udentries, uint8_t count)
+{
+	uint8_t flags;
+	struct file_open *ofile = file_fd_resolve(dir, &flags);
+	if (ofile == NULL) {
+		return -EBADF;
+	}
+
+	if ((flags & O_WRONLY) || !S_ISDIR(ofile->file->attr)) {
+		file_file_put(ofile);
+		return -EINVAL;
+	}
+
+	uint8_t chunk = (count < FILE_DENTS_CHUNK) ? count : FILE_DENTS_CHUNK;
+	struct fs_dentry *dentries = kmalloc(chunk * sizeof(struct fs_dentry));
+	if (dentries == NULL) {
+		file_file_put(ofile);
+		return chunk ? -ENOMEM : 0;
+	}
+
+	int16_t total = 0, ret = 0;
+
+	lock_lock(&ofile->lock);
+
+	while (total < count) {
+		uint16_t idx = ofile->offset;
+		uint8_t n = count - total;
+		if (n > chunk) {
+			n = chunk;
+		}
+
+		ret = fs_getdents(ofile->file, dentries, n, &idx);
+		if (ret <= 0) {
+			break;
+		}
+
+		int8_t err = copyout(udentries + total, dentries, ret * sizeof(struct fs_dentry));
+		if (err < 0) {
+			ret = err;
+			break;
+		}
+
+		ofile->offset = idx;
+		total += ret;
+
+		if (ret < n) {
+			break;
+		}
+	}
+
+	lock_unlock(&ofile->lock);
+
+	kfree(dentries);
+	file_file_put(ofile);
+
+	return (total > 0) ? total : ret;
+}
+
+int8_t file_remove(const char *upath)
+{
+	char *path;
+	int8_t ret = strdup_user(&path, upath);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = fs_remove(path);
+	kfree(path);
+
+	return ret;
+}
+
+static int16_t file_batch_one(const struct sys_batch *entry)
+{
+	switch (entry->op) {
+		case SYS_BATCH_READ:
+			return file_read(entry->fd, entry->buff, entry->len);
+
+		case SYS_BATCH_WRITE:
+			return file_write(entry->fd, entry->buff, entry->len);
+
+		case SYS_BATCH_CLOSE:
+			return file_close(entry->fd);
+
+		default:
+			return -EINVAL;
+	}
+}
+
+int16_t file_batch(struct sys_batch *uentries, uint8_t count)
+{
+	struct sys_batch entries[FILE_BATCH_CHUNK];
+	uint8_t done = 0;
+
+	while (done < count) {
+		uint8_t n = count - done;
+		if (n > FILE_BATCH_CHUNK) {
+			n = FILE_BATCH_CHUNK;
+		}
+
+		int8_t err = copyin(entries, &uentries[done], n * sizeof(*entries));
+		if (err < 0) {
+			return done ? done : err;
+		}
+
+		uint8_t failed = 0;
+		for (uint8_t i = 0; i < n; ++i) {
+			entries[i].ret = file_batch_one(&entries[i]);
+			if (entries[i].ret < 0) {
+				n = i + 1;
+				failed = 1;
+				break;
+			}
+		}
+
+		err = copyout(&uentries[done], entries, n * sizeof(*entries));
+		if (err < 0) {
+			return done ? done : err;
+		}
+
+		done += n;
+		if (failed) {
+			break;
+		}
+	}
+
+	return done;
+}
+
+void file_init(void)
 {
-	return fs_remove(path);
+	lock_init(&common.lock);
+	lockstat_register(&common.lock, &common.lstat, "file");
 }
@@ -9,6 +9,11 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/batch.h>
+#include <sys/uio.h>
+#include <sys/poll.h>
+#include <sys/ioctl.h>
+#include <sys/statfs.h>
 
 #include "fs/fs.h"
 #include "proc/lock.h"
@@ -25,16 +30,31 @@ struct file_descriptor {
 	uint8_t flags;
 };
 
+/* Syscall layer, buffers and paths are user space addresses */
+
 void file_fdtable_copy(struct process *parent, struct process *child);
 int8_t file_dup2(int8_t oldfd, int8_t newfd);
 int8_t file_open(const char *path, uint8_t mode, uint8_t attr);
+int8_t file_pipe(int8_t *fds);
 void file_close_all(struct process *process);
 int8_t file_close(int8_t fd);
 int16_t file_read(int8_t fd, void *buff, size_t bufflen);
 int16_t file_write(int8_t fd, const void *buff, size_t bufflen);
+int16_t file_prw(int8_t fd, void *buff, size_t bufflen, off_t offs, uint8_t write);
+int8_t file_lseek(int8_t fd, off_t *offs, int8_t whence);
+int16_t file_sendfile(int8_t outfd, int8_t infd, off_t *offs, size_t count);
+int16_t file_rwv(int8_t fd, const struct iovec *iov, uint8_t iovcnt, uint8_t write);
 int8_t file_truncate(const char *path, off_t size);
 int8_t file_ftruncate(int8_t fd, off_t size);
+int8_t file_fsync(int8_t fd);
+int8_t file_fallocate(int8_t fd, off_t len);
+int8_t file_statfs(const char *path, struct statfs *buf);
 int8_t file_readdir(int8_t dir, struct fs_dentry *dentry, uint16_t idx);
+int16_t file_getdents(int8_t dir, struct fs_dentry *dentries, uint8_t count);
 int8_t file_remove(const char *path);
+int8_t file_ioctl(int8_t fd, int16_t op, void *arg);
+int16_t file_poll(struct pollfd *fds, uint8_t nfds, int16_t timeout);
+int16_t file_batch(struct sys_batch *entries, uint8_t count);
+void file_init(void);
 
 #endif
@@ -11,6 +11,8 @@
 
 #include "lib/errno.h"
 #include "lib/assert.h"
+#include "lib/trace.h"
+#include "proc/timer.h"
 
 static int8_t _lock_try(struct lock *lock)
 {
@@ -20,15 +22,55 @@ static int8_t _lock_try(struct lock *lock)
 
 	lock->locked = 1;
 
+	if (lock->stat != NULL) {
+		++lock->stat->acquired;
+		lock->stamp = timer_stamp();
+	}
+
 	return 0;
 }
 
+static void _lock_release(struct lock *lock)
+{
+	if (lock->stat != NULL) {
+		uint32_t hold = timer_stamp() - lock->stamp;
+		if (hold > lock->stat->hold_max) {
+			lock->stat->hold_max = hold;
+		}
+	}
+
+	lock->locked = 0;
+}
+
 void _lock_lock(struct lock *lock)
 {
 	assert(lock != NULL);
 
-	while (_lock_try(lock) < 0) {
-		_thread_wait(&lock->queue, 0);
+	if (_lock_try(lock) < 0) {
+		struct lock_stat *stat = lock->stat;
+		uint32_t start = 0;
+
+		trace_event(TRACE_EV_LOCK_WAIT, 0, (uint16_t)lock);
+
+		if (stat != NULL) {
+			++stat->contended;
+			start = timer_stamp();
+		}
+
+		do {
+			_thread_wait(&lock->queue, 0);
+		} while (_lock_try(lock) < 0);
+
+		if (stat != NULL) {
+			/* Acquisition stamp has been just set by _lock_try() */
+			uint32_t wait = lock->stamp - start;
+			stat->wait += wait;
+			if (wait > stat->wait_max) {
+				stat->wait_max = wait;
+			}
+		}
+
+		trace_event(TRACE_EV_LOCK_TAKEN, 0, (uint16_t)lock);
 	}
 }
 
@@ -36,7 +78,7 @@ void _lock_unlock(struct lock *lock)
 {
 	assert(lock != NULL);
 
-	lock->locked = 0;
+	_lock_release(lock);
 	_thread_signal(&lock->queue);
 }
 
@@ -65,7 +107,7 @@ void lock_unlock(struct lock *lock)
 	assert(lock != NULL);
 
 	thread_critical_start();
-	lock->locked = 0;
+	_lock_release(lock);
 	_thread_signal_yield(&lock->queue);
 }
 
@@ -75,4 +117,5 @@ void lock_init(struct lock *lock)
 
 	lock->queue = NULL;
 	lock->locked = 0;
+	lock->stat = NULL;
 }
@@ -11,9 +11,23 @@
 
 #include "proc/thread.h"
 
+/* Optional contention statistics, times in PRT0 ticks (TIMER_STAMP_HZ).
+ * One lock_stat can be shared by a class of locks. */
+struct lock_stat {
+	struct lock_stat *next;
+	const char *name;
+	uint32_t acquired;
+	uint32_t contended;
+	uint32_t wait;
+	uint32_t wait_max;
+	uint32_t hold_max;
+};
+
 struct lock {
 	struct thread *queue;
 	volatile int8_t locked;
+	struct lock_stat *stat;
+	uint32_t stamp;
 };
 
 void _lock_lock(struct lock *lock);
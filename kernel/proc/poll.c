@@ -0,0 +1,44 @@
+/* ZAK180 Firmaware
+ * Readiness wait queue
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "proc/poll.h"
+#include "proc/thread.h"
+
+/* Pollers sleep with a timeout, so interrupts cannot signal
+ * them directly (_thread_signal_irq), set a flag instead */
+
+static struct {
+	struct thread *queue;
+	volatile uint8_t pending;
+} common;
+
+void _poll_notify(void)
+{
+	common.pending = 1;
+}
+
+void poll_notify(void)
+{
+	thread_critical_start();
+	(void)_thread_broadcast(&common.queue);
+	thread_critical_end();
+}
+
+void _poll_on_tick(void)
+{
+	if (common.pending) {
+		common.pending = 0;
+		(void)_thread_broadcast(&common.queue);
+	}
+}
+
+int8_t _poll_wait(time_t wakeup)
+{
+	return _thread_wait(&common.queue, wakeup);
+}
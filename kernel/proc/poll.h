@@ -0,0 +1,27 @@
+/* ZAK180 Firmaware
+ * Readiness wait queue
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_POLL_H_
+#define KERNEL_POLL_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/* Single queue shared by all pollers, every readiness
+ * change wakes all of them and they recheck their fds. */
+
+/* Interrupt context, wakeup is deferred to the next tick */
+void _poll_notify(void);
+
+void poll_notify(void);
+
+/* Called from the scheduler tick with interrupts disabled */
+void _poll_on_tick(void);
+
+/* Caller is in the thread critical section, wakeup is absolute (0 - none) */
+int8_t _poll_wait(time_t wakeup);
+
+#endif
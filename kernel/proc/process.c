@@ -15,6 +15,7 @@
 
 #include "mem/page.h"
 #include "mem/kmalloc.h"
+#include "mem/uaccess.h"
 
 #include "lib/errno.h"
 #include "lib/assert.h"
@@ -22,6 +23,7 @@
 #include "lib/list.h"
 #include "lib/kprintf.h"
 #include "lib/panic.h"
+#include "lib/lockstat.h"
 
 #include "driver/mmu.h"
 #include "driver/dma.h"
@@ -29,6 +31,8 @@
 static struct {
 	struct id_storage pid;
 	struct lock plock;
+	struct lock_stat plstat;
+	struct lock_stat lstat;
 } common;
 
 struct process *_process_get(id_t pid)
@@ -116,12 +120,69 @@ static int8_t process_load(uint8_t mpage, const char *path)
 
 extern void _thread_jmp(uint8_t nstack, uint8_t ostack, void *sp);
 
-static int8_t process_do_exec(struct process *process, uint8_t mmap, char *const argv[])
+/* Max number of execv() arguments */
+#define PROCESS_ARGC_MAX 16
+
+static void process_argv_free(char **argv)
+{
+	if (argv != NULL) {
+		for (char **arg = argv; *arg != NULL; ++arg) {
+			kfree(*arg);
+		}
+		kfree(argv);
+	}
+}
+
+/* Copy user argv to the kernel, process memory is released
+ * before the new stack is built, so it can't be used there */
+static int8_t process_argv_copyin(char ***argv, char *const uargv[])
+{
+	uint8_t argc = 0;
+	char *arg;
+	int8_t err;
+
+	*argv = NULL;
+	if (uargv == NULL) {
+		return 0;
+	}
+
+	do {
+		if (argc >= PROCESS_ARGC_MAX) {
+			return -EINVAL;
+		}
+
+		err = copyin(&arg, &uargv[argc++], sizeof(arg));
+		if (err < 0) {
+			return err;
+		}
+	} while (arg != NULL);
+
+	char **kargv = kmalloc(argc * sizeof(char *));
+	if (kargv == NULL) {
+		return -ENOMEM;
+	}
+	memset(kargv, 0, argc * sizeof(char *));
+
+	for (uint8_t i = 0; i < argc - 1; ++i) {
+		err = copyin(&arg, &uargv[i], sizeof(arg));
+		if ((err < 0) || ((err = strdup_user(&kargv[i], arg)) < 0)) {
+			process_argv_free(kargv);
+			return err;
+		}
+	}
+
+	*argv = kargv;
+
+	return 0;
+}
+
+static int8_t process_do_exec(struct process *process, uint8_t mmap, char *const argv[], uint8_t release)
 {
 	/* Assume process is prepared for execution,
 	 * i.e. it's created, we're executing its
 	 * main thread, memory map is allocated and
-	 * process has been loaded */
+	 * process has been loaded. If release is set
+	 * argv is freed once it's not needed anymore. */
 
 	struct thread *current = thread_current();
 	uint8_t nstack = page_alloc(process, 1), ostack = current->stack_page;
@@ -174,6 +235,10 @@ static int8_t process_do_exec(struct process *process, uint8_t mmap, char *const
 	/* Relocate the sp to the stack space */
 	stack += PAGE_SIZE;
 
+	if (release) {
+		process_argv_free((char **)argv);
+	}
+
 	_DI;
 	mmu_map_user(mmap);
 	current->stack_page = nstack;
@@ -183,23 +248,43 @@ static int8_t process_do_exec(struct process *process, uint8_t mmap, char *const
 	return 0;
 }
 
-int8_t process_execv(const char *path, char *const argv[])
+int8_t process_execv(const char *upath, char *const uargv[])
 {
 	struct process *current = thread_current()->process;
 	assert(current != NULL);
 
+	char *path;
+	char **argv;
+	int8_t err = strdup_user(&path, upath);
+	if (err < 0) {
+		return err;
+	}
+
+	err = process_argv_copyin(&argv, uargv);
+	if (err < 0) {
+		kfree(path);
+		return err;
+	}
+
 	uint8_t nmap = page_alloc(current, PROCESS_PAGES);
 	if (!nmap) {
+		process_argv_free(argv);
+		kfree(path);
 		return -ENOMEM;
 	}
 
-	int8_t err = process_load(nmap, path);
+	err = process_load(nmap, path);
+	kfree(path);
 	if (err) {
 		page_free(nmap, PROCESS_PAGES);
+		process_argv_free(argv);
 		return err;
 	}
 
-	return process_do_exec(current, nmap, argv);
+	err = process_do_exec(current, nmap, argv, 1);
+	process_argv_free(argv);
+
+	return err;
 }
 
 static struct process *process_create(void)
@@ -214,6 +299,7 @@ static struct process *process_create(void)
 		}
 
 		lock_init(&p->lock);
+		lockstat_register(&p->lock, &common.lstat, "process");
 
 		p->refs = 1;
 	}
@@ -258,6 +344,10 @@ static void process_fork_thread(void *arg)
 	fdata->state = fork_done;
 	_thread_signal(&fdata->queue);
 
+	/* Child returns from the parent's syscall */
+	current->syscall = fdata->tparent->syscall;
+	current->sysstamp = fdata->tparent->sysstamp;
+
 	/* Assign new stack */
 	_DI;
 	fdata->old_stack = current->stack_page;
@@ -379,7 +469,7 @@ void process_start_thread(void *arg)
 	assert(process != NULL);
 	char *const *argv = arg;
 
-	(void)process_do_exec(process, process->mpage, argv);
+	(void)process_do_exec(process, process->mpage, argv, 0);
 	panic();
 }
 
@@ -559,4 +649,5 @@ void process_init(void)
 {
 	id_init(&common.pid);
 	lock_init(&common.plock);
+	lockstat_register(&common.plock, &common.plstat, "plock");
 }
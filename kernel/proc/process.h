@@ -9,6 +9,7 @@
 
 #include "mem/page.h"
 #include "lib/id.h"
+#include "lib/sysstat.h"
 #include "lock.h"
 #include "file.h"
 
@@ -46,6 +47,9 @@ struct process {
 	/* Resources */
 	struct file_descriptor fdtable[16];
 
+	/* Syscall statistics */
+	struct sysstat_proc sysstat;
+
 	/* PID */
 	int8_t refs;
 	struct id_linkage pid;
@@ -57,6 +61,7 @@ struct process *process_get(id_t pid);
 
 void process_put(struct process *process);
 
+/* path and argv are user space addresses */
 int8_t process_execv(const char *path, char *const argv[]);
 
 id_t process_fork(void);
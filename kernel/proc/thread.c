@@ -9,6 +9,7 @@
 #include "proc/thread.h"
 #include "proc/lock.h"
 #include "proc/process.h"
+#include "proc/poll.h"
 
 #include "mem/page.h"
 #include "mem/kmalloc.h"
@@ -22,6 +23,7 @@
 #include "lib/assert.h"
 #include "lib/bheap.h"
 #include "lib/id.h"
+#include "lib/trace.h"
 
 static struct {
 	struct thread *ready[THREAD_PRIORITY_NO];
@@ -239,6 +241,11 @@ void _thread_schedule(struct cpu_context *context)
 		}
 	}
 
+	if (common.current != prev) {
+		struct process *process = common.current->process;
+		trace_event(TRACE_EV_SCHED, (process != NULL) ? process->pid.id : 0, (uint16_t)common.current);
+	}
+
 	_DI;
 	common.schedule = 1;
 }
@@ -265,6 +272,7 @@ void _thread_on_tick(struct cpu_context *context)
 	if (common.schedule) {
 		/* Put threads signaled by interrupts to the ready list */
 		(void)_thread_broadcast(&common.irq_signaled);
+		_poll_on_tick();
 
 		/* Allow HW IRQ to preempt the scheduler */
 		common.schedule = 0;
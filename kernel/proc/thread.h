@@ -46,6 +46,10 @@ struct thread {
 
 	struct cpu_context *context;
 	uint8_t stack_page;
+
+	/* Syscall in progress (for tracing and statistics) */
+	uint8_t syscall;
+	uint32_t sysstamp;
 };
 
 void thread_critical_start(void);
@@ -8,9 +8,13 @@
 #include "thread.h"
 #include "driver/prt.h"
 #include "driver/critical.h"
+#include "lib/trace.h"
+#include "lib/prof.h"
 
 static struct {
 	time_t jiffies;
+	uint32_t stamp;
+	uint16_t reload;
 } common;
 
 time_t _timer_get(void)
@@ -27,13 +31,33 @@ time_t timer_get(void)
 	return ret;
 }
 
+uint32_t _timer_stamp(void)
+{
+	/* PRT counts down. If it has reloaded, but the IRQ is
+	 * still pending, the stamp goes back by one systick. */
+	return common.stamp + (common.reload - _prt0_timer_get());
+}
+
+uint32_t timer_stamp(void)
+{
+	critical_start();
+	uint32_t ret = _timer_stamp();
+	critical_end();
+
+	return ret;
+}
+
 void timer_irq_handler(struct cpu_context *context)
 {
 	common.jiffies += SYSTICK_INTERVAL;
+	common.stamp += common.reload;
+	_trace_event(TRACE_EV_IRQ, TRACE_IRQ_SYSTICK, 0);
+	_prof_tick(context);
 	_thread_on_tick(context);
 }
 
 void timer_init(void)
 {
+	common.reload = prt_ms_to_val(SYSTICK_INTERVAL);
 	prt0_init(SYSTICK_INTERVAL);
 }
@@ -14,10 +14,19 @@
 
 #define SYSTICK_INTERVAL 10 /* ms */
 
+/* Timestamp resolution - PRT runs at CPU clock / 20 */
+#define TIMER_STAMP_HZ 307200UL
+
 time_t _timer_get(void);
 
 time_t timer_get(void);
 
+/* High resolution, free running timestamp (TIMER_STAMP_HZ),
+ * wraps around every ~3.9 hours. Meant for measurements only. */
+uint32_t _timer_stamp(void);
+
+uint32_t timer_stamp(void);
+
 void timer_irq_handler(struct cpu_context *context);
 
 void timer_init(void);
@@ -9,12 +9,17 @@
 #include <stdint.h>
 
 #include "driver/mmu.h"
+#include "mem/uaccess.h"
 #include "lib/assert.h"
 #include "lib/kprintf.h"
 #include "lib/errno.h"
+#include "lib/trace.h"
+#include "lib/sysstat.h"
 #include "proc/process.h"
 #include "proc/thread.h"
 #include "proc/file.h"
+#include "proc/timer.h"
+#include "syscall.h"
 
 /* Every syscall has to have uintptr_t as a first argument!
  * This is a placeholder for the user space return address. */
@@ -24,6 +29,23 @@
  * ABI translation, but sadly does jp _func instead of call _func,
  * so the code is never executed. */
 
+void syscall_enter(uint8_t no, const uint16_t *args)
+{
+	struct thread *curr = thread_current();
+
+	curr->syscall = no;
+	trace_event(TRACE_EV_SYS_ENTER, no, args[0]);
+	sysstat_enter(curr, args);
+}
+
+void syscall_exit(int16_t ret)
+{
+	struct thread *curr = thread_current();
+
+	sysstat_exit(curr, ret);
+	trace_event(TRACE_EV_SYS_EXIT, curr->syscall, ret);
+}
+
 int syscall_fork(uintptr_t raddr) __sdcccall(0)
 {
 	(void)raddr;
@@ -34,7 +56,14 @@ int syscall_fork(uintptr_t raddr) __sdcccall(0)
 int syscall_waitpid(uintptr_t raddr, id_t pid, int *status, int8_t options) __sdcccall(0)
 {
 	(void)raddr;
-	id_t ret = process_wait(pid, status, options);
+	int kstatus;
+	id_t ret = process_wait(pid, &kstatus, options);
+	if ((ret > 0) && (status != NULL)) {
+		int8_t err = copyout(status, &kstatus, sizeof(kstatus));
+		if (err < 0) {
+			ret = err;
+		}
+	}
 	return ret;
 }
 
@@ -121,3 +150,144 @@ int syscall_dup2(uintptr_t raddr, int8_t oldfd, int8_t newfd) __sdcccall(0)
 	int ret = file_dup2(oldfd, newfd);
 	return ret;
 }
+
+int syscall_batch(uintptr_t raddr, struct sys_batch *entries, uint8_t count) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_batch(entries, count);
+	return ret;
+}
+
+int syscall_readv(uintptr_t raddr, int8_t fd, const struct iovec *iov, uint8_t iovcnt) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_rwv(fd, iov, iovcnt, 0);
+	return ret;
+}
+
+int syscall_writev(uintptr_t raddr, int8_t fd, const struct iovec *iov, uint8_t iovcnt) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_rwv(fd, iov, iovcnt, 1);
+	return ret;
+}
+
+int syscall_lseek(uintptr_t raddr, int8_t fd, off_t *offset, int8_t whence) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_lseek(fd, offset, whence);
+	return ret;
+}
+
+int syscall_pread(uintptr_t raddr, int8_t fd, void *buff, size_t bufflen, off_t offset) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_prw(fd, buff, bufflen, offset, 0);
+	return ret;
+}
+
+int syscall_pwrite(uintptr_t raddr, int8_t fd, const void *buff, size_t bufflen, off_t offset) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_prw(fd, (void *)buff, bufflen, offset, 1);
+	return ret;
+}
+
+int syscall_poll(uintptr_t raddr, struct pollfd *fds, uint8_t nfds, int16_t timeout) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_poll(fds, nfds, timeout);
+	return ret;
+}
+
+int syscall_ioctl(uintptr_t raddr, int8_t fd, int16_t op, void *arg) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_ioctl(fd, op, arg);
+	return ret;
+}
+
+int syscall_pipe(uintptr_t raddr, int8_t *fds) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_pipe(fds);
+	return ret;
+}
+
+int syscall_sendfile(uintptr_t raddr, int8_t outfd, int8_t infd, off_t *offs, size_t count) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_sendfile(outfd, infd, offs, count);
+	return ret;
+}
+
+int syscall_getdents(uintptr_t raddr, int8_t dir, struct fs_dentry *dentries, uint8_t count) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_getdents(dir, dentries, count);
+	return ret;
+}
+
+int syscall_statfs(uintptr_t raddr, const char *path, struct statfs *buf) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_statfs(path, buf);
+	return ret;
+}
+
+int syscall_sync(uintptr_t raddr) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = fs_sync();
+	return ret;
+}
+
+int syscall_fsync(uintptr_t raddr, int8_t fd) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_fsync(fd);
+	return ret;
+}
+
+int syscall_fallocate(uintptr_t raddr, int8_t fd, off_t len) __sdcccall(0)
+{
+	(void)raddr;
+	int ret = file_fallocate(fd, len);
+	return ret;
+}
+
+uint32_t syscall_time(uintptr_t raddr) __sdcccall(0)
+{
+	(void)raddr;
+	uint32_t ret = timer_stamp();
+	return ret;
+}
+
+/* Register based entry (rst 0x30): __sdcccall(1) handlers,
+ * no return address placeholder, up to two arguments in
+ * registers and the optional 3rd one on the stack. */
+
+int16_t fsyscall_nosys(void)
+{
+	return -ENOSYS;
+}
+
+int16_t fsyscall_msleep(uint16_t mseconds)
+{
+	return thread_sleep_relative(mseconds);
+}
+
+int16_t fsyscall_read(int16_t fd, void *buff, size_t bufflen)
+{
+	return file_read((int8_t)fd, buff, bufflen);
+}
+
+int16_t fsyscall_write(int16_t fd, const void *buff, size_t bufflen)
+{
+	return file_write((int8_t)fd, buff, bufflen);
+}
+
+uint32_t fsyscall_time(void)
+{
+	return timer_stamp();
+}
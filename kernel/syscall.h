@@ -0,0 +1,25 @@
+/* ZAK180 Firmaware
+ * Syscalls
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef KERNEL_SYSCALL_H_
+#define KERNEL_SYSCALL_H_
+
+#include <stdint.h>
+
+/* Number of entries in _syscall_table (hal/crt0.s) */
+#define SYSCALL_COUNT 30
+
+#define SYSCALL_TIME  14
+#define SYSCALL_BATCH 15
+
+/* Dispatcher hooks, args points to the raw
+ * arguments on the user stack */
+
+void syscall_enter(uint8_t no, const uint16_t *args);
+
+void syscall_exit(int16_t ret);
+
+#endif
@@ -0,0 +1,45 @@
+/* ZAK180 Firmaware
+ * Kernel unit tests - fs inode cache
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include "fs/fs.h"
+#include "lib/kprintf.h"
+
+/* Second open is served from the inode cache */
+static int reopen(const char *path)
+{
+	for (int i = 0; i < 2; ++i) {
+		struct fs_file *file;
+		int8_t err = fs_open(path, &file, O_RDONLY, 0);
+		if (err < 0) {
+			kprintf("%s: open %d failed (%d)\r\n", path, i, err);
+			return -1;
+		}
+
+		fs_close(file);
+	}
+
+	return 0;
+}
+
+void test_fs(void)
+{
+	kprintf("Reopen a directory\r\n");
+	if (reopen("/BOOT") < 0) {
+		return;
+	}
+
+	kprintf("Reopen a file through a cached directory\r\n");
+	if (reopen("/BOOT/INIT.ZEX") < 0) {
+		return;
+	}
+
+	kprintf("Reopen the root directory\r\n");
+	if (reopen("/") < 0) {
+		return;
+	}
+
+	kprintf("Done\r\n");
+}
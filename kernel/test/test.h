@@ -11,4 +11,7 @@ void test_kmalloc(void);
 
 void test_condwait(void);
 
+/* Needs the root filesystem mounted */
+void test_fs(void);
+
 #endif
@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# ZAK180 Firmaware
+# Interrupt latency report decoder
+# Copyright: Aleksander Kaminski, 2025
+# See LICENSE.md
+#
+# Usage: irqlat.py <dump> [kernel.noi]
+# Dump is the raw content read from /DEV/IRQLAT0, optional
+# .noi file is used to symbolize critical section call sites.
+
+import bisect
+import struct
+import sys
+
+STAMP_HZ = 307200
+CRITICAL_HIST = 12
+CRITICAL_TOP = 8
+IRQLAT_HIST = 16
+REPORT = "<%uH%uH%uHI" % (CRITICAL_HIST, 2 * CRITICAL_TOP, IRQLAT_HIST)
+
+
+def us(ticks):
+    return ticks * 1000000 // STAMP_HZ
+
+
+def load_symbols(path):
+    syms = []
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) == 3 and fields[0] == "DEF" and not fields[1].startswith(("s__", "l__")):
+                syms.append((int(fields[2], 16), fields[1]))
+    syms.sort()
+    return syms
+
+
+def symbolize(syms, addr):
+    idx = bisect.bisect_right([s[0] for s in syms], addr) - 1
+    if idx < 0:
+        return "0x%04x" % addr
+    return "%s+0x%x" % (syms[idx][1], addr - syms[idx][0])
+
+
+def histogram(title, hist):
+    print(title)
+    for i, count in enumerate(hist):
+        if count:
+            low = 0 if not i else 1 << i
+            print("  >= %8u us %8u" % (us(low), count))
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: %s <dump> [kernel.noi]" % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    syms = load_symbols(sys.argv[2]) if len(sys.argv) > 2 else []
+    fields = struct.unpack_from(REPORT, data, 0)
+    chist = fields[:CRITICAL_HIST]
+    top = fields[CRITICAL_HIST:CRITICAL_HIST + 2 * CRITICAL_TOP]
+    whist = fields[CRITICAL_HIST + 2 * CRITICAL_TOP:-1]
+    wmax = fields[-1]
+
+    histogram("interrupts disabled windows:", chist)
+    print("worst windows:")
+    windows = sorted(zip(top[0::2], top[1::2]), key=lambda x: -x[1])
+    for site, ticks in windows:
+        if ticks:
+            print("  %8u us  %s" % (us(ticks), symbolize(syms, site) if syms else "0x%04x" % site))
+
+    histogram("UART RX irq to wakeup:", whist)
+    print("  max %u us" % us(wmax))
+
+
+if __name__ == "__main__":
+    main()
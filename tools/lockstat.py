@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+# ZAK180 Firmaware
+# Lock contention statistics decoder
+# Copyright: Aleksander Kaminski, 2025
+# See LICENSE.md
+#
+# Usage: lockstat.py <dump>
+# Dump is the raw content read from /DEV/LOCKSTAT0.
+
+import struct
+import sys
+
+STAMP_HZ = 307200
+RECORD = "<8s5I"
+
+
+def us(ticks):
+    return ticks * 1000000 // STAMP_HZ
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: %s <dump>" % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    print("%-8s %10s %10s %12s %10s %10s" % ("lock", "acquired", "contended", "wait us", "wait max", "hold max"))
+
+    size = struct.calcsize(RECORD)
+    for offs in range(0, len(data) - len(data) % size, size):
+        name, acquired, contended, wait, wait_max, hold_max = struct.unpack_from(RECORD, data, offs)
+        name = name.split(b"\0")[0].decode("ascii", "replace")
+        print("%-8s %10u %10u %12u %10u %10u" % (name, acquired, contended, us(wait), us(wait_max), us(hold_max)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# ZAK180 Firmaware
+# Profiler histogram symbolizer
+# Copyright: Aleksander Kaminski, 2025
+# See LICENSE.md
+#
+# Usage: prof.py <dump> <kernel.noi> [user.noi] [top]
+# Dump is the raw content read from /DEV/PROF0: kernel
+# histogram followed by the user space histogram, 2048
+# 16-bit counters each, one counter per 32 bytes.
+
+import bisect
+import struct
+import sys
+
+BUCKET_SHIFT = 5
+BUCKETS = 0x10000 >> BUCKET_SHIFT
+
+
+def load_symbols(path):
+    syms = []
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) != 3 or fields[0] != "DEF":
+                continue
+            name = fields[1]
+            # Skip linker generated area symbols
+            if name.startswith(("s__", "l__")):
+                continue
+            syms.append((int(fields[2], 16), name))
+    syms.sort()
+    return syms
+
+
+def symbolize(syms, addr):
+    idx = bisect.bisect_right([s[0] for s in syms], addr) - 1
+    if idx < 0:
+        return "0x%04x" % addr
+    return syms[idx][1]
+
+
+def report(title, hist, syms, top):
+    total = sum(hist)
+    print("%s: %u samples" % (title, total))
+    if not total:
+        return
+
+    funcs = {}
+    for bucket, count in enumerate(hist):
+        if count:
+            name = symbolize(syms, bucket << BUCKET_SHIFT)
+            funcs[name] = funcs.get(name, 0) + count
+
+    for name, count in sorted(funcs.items(), key=lambda x: -x[1])[:top]:
+        print("  %6.2f%% %8u  %s" % (100.0 * count / total, count, name))
+    print()
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: %s <dump> <kernel.noi> [user.noi] [top]" % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    kernel = struct.unpack_from("<%uH" % BUCKETS, data, 0)
+    user = struct.unpack_from("<%uH" % BUCKETS, data, 2 * BUCKETS)
+
+    ksyms = load_symbols(sys.argv[2])
+    usyms = load_symbols(sys.argv[3]) if len(sys.argv) > 3 else []
+    top = int(sys.argv[4]) if len(sys.argv) > 4 else 20
+
+    # User layout below 0x1000 is the kernel entry point
+    usyms = [s for s in ksyms if s[0] < 0x1000] + [s for s in usyms if s[0] >= 0x1000]
+
+    report("kernel", kernel, ksyms, top)
+    report("user", user, usyms, top)
+
+
+if __name__ == "__main__":
+    main()
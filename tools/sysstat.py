@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+# ZAK180 Firmaware
+# Syscall statistics decoder
+# Copyright: Aleksander Kaminski, 2025
+# See LICENSE.md
+#
+# Usage: sysstat.py <dump>
+# Dump is the raw content read from /DEV/SYSSTAT0.
+
+import struct
+import sys
+
+STAMP_HZ = 307200
+
+SYSCALLS = [
+    "fork", "waitpid", "process_end", "msleep", "execv", "open", "close",
+    "read", "write", "truncate", "ftruncate", "readdir", "remove", "dup2", "time",
+    "batch", "readv", "writev", "lseek", "pread", "pwrite",
+    "poll", "ioctl", "pipe", "sendfile",
+    "getdents", "statfs", "sync", "fsync", "fallocate",
+]
+
+BUCKETS = 8
+STAT = "<IHH%uH" % BUCKETS
+PROC = "<%uHHI" % len(SYSCALLS)
+
+
+def us(ticks):
+    return ticks * 1000000 // STAMP_HZ
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: %s <dump>" % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    limits = ["<%u" % us(4 ** (i + 1)) for i in range(BUCKETS - 1)] + [">=%u" % us(4 ** (BUCKETS - 1))]
+    print("%-12s %8s %6s %8s  %s" % ("syscall", "calls", "errors", "max us", " ".join("%7s" % l for l in limits)))
+
+    offs = 0
+    for name in SYSCALLS:
+        fields = struct.unpack_from(STAT, data, offs)
+        offs += struct.calcsize(STAT)
+        calls, errors, ticks = fields[:3]
+        if calls:
+            print("%-12s %8u %6u %8u  %s" % (name, calls, errors, us(ticks), " ".join("%7u" % h for h in fields[3:])))
+
+    if len(data) >= offs + struct.calcsize(PROC):
+        fields = struct.unpack_from(PROC, data, offs)
+        calls = fields[:len(SYSCALLS)]
+        if sum(calls):
+            print()
+            print("selected process: %u errors, %u us in syscalls" % (fields[-2], us(fields[-1])))
+            for name, count in zip(SYSCALLS, calls):
+                if count:
+                    print("  %-12s %6u" % (name, count))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# ZAK180 Firmaware
+# Kernel event trace decoder
+# Copyright: Aleksander Kaminski, 2025
+# See LICENSE.md
+#
+# Usage: trace.py <dump>
+# Dump is the raw content read from /DEV/TRACE0.
+
+import struct
+import sys
+
+STAMP_HZ = 307200
+
+EVENTS = {
+    0x00: "sched",
+    0x10: "sys_enter",
+    0x11: "sys_exit",
+    0x20: "lock_wait",
+    0x21: "lock_taken",
+    0x30: "blk_read",
+    0x31: "blk_write",
+    0x32: "blk_done",
+    0x40: "irq",
+}
+
+SYSCALLS = [
+    "fork", "waitpid", "process_end", "msleep", "execv", "open", "close",
+    "read", "write", "truncate", "ftruncate", "readdir", "remove", "dup2", "time",
+    "batch", "readv", "writev", "lseek", "pread", "pwrite",
+    "poll", "ioctl", "pipe", "sendfile",
+    "getdents", "statfs", "sync", "fsync", "fallocate",
+]
+
+IRQS = ["systick", "uart0", "uart1"]
+
+
+def describe(event, arg8, arg16):
+    if event == 0x00:
+        return "pid %u thread 0x%04x" % (arg8, arg16)
+    if event in (0x10, 0x11):
+        name = SYSCALLS[arg8] if arg8 < len(SYSCALLS) else str(arg8)
+        if event == 0x11 and arg16 >= 0x8000:
+            arg16 -= 0x10000
+        return "%s %d" % (name, arg16)
+    if event in (0x20, 0x21):
+        return "lock 0x%04x" % arg16
+    if event in (0x30, 0x31):
+        return "sector %u" % arg16
+    if event == 0x32:
+        return "sector %u%s" % (arg16, " error" if arg8 else "")
+    if event == 0x40:
+        return IRQS[arg8] if arg8 < len(IRQS) else str(arg8)
+    return "0x%02x 0x%04x" % (arg8, arg16)
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: %s <dump>" % sys.argv[0])
+        sys.exit(1)
+
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+
+    first = None
+    prev = None
+    for offs in range(0, len(data) - len(data) % 8, 8):
+        stamp, event, arg8, arg16 = struct.unpack_from("<IBBH", data, offs)
+        if first is None:
+            first = stamp
+            prev = stamp
+        rel = ((stamp - first) & 0xFFFFFFFF) * 1000000 // STAMP_HZ
+        delta = ((stamp - prev) & 0xFFFFFFFF) * 1000000 // STAMP_HZ
+        prev = stamp
+        name = EVENTS.get(event, "0x%02x" % event)
+        print("%10u us %+8d us  %-10s %s" % (rel, delta, name, describe(event, arg8, arg16)))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,113 @@
+/* ZAK180 User Space App
+ * Syscall entry and pipe benchmarks
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#define BENCH_CALLS 1000
+
+#define BENCH_PIPE_CHUNK 512
+#define BENCH_PIPE_SIZE  (64 * 1024UL)
+
+/* PRT0 tick is 20 CPU clocks */
+#define BENCH_CYCLES_PER_TICK 20
+
+static void bench_report(const char *name, clock_t ticks)
+{
+	unsigned long cycles = ((unsigned long)ticks * BENCH_CYCLES_PER_TICK) / BENCH_CALLS;
+	printf("%s: %lu ticks, %lu cycles/call\r\n", name, (unsigned long)ticks, cycles);
+}
+
+static void bench_syscall(void)
+{
+	uint16_t i;
+	clock_t start, end;
+
+	start = clock();
+	for (i = 0; i < BENCH_CALLS; ++i) {
+		(void)__sys_time();
+	}
+	end = clock();
+	bench_report("rst 0x38", end - start);
+
+	start = clock();
+	for (i = 0; i < BENCH_CALLS; ++i) {
+		(void)__fsys_time();
+	}
+	end = clock();
+	bench_report("rst 0x30", end - start);
+}
+
+static void bench_pipe(void)
+{
+	static char buff[BENCH_PIPE_CHUNK];
+	unsigned long total = 0;
+	int8_t fds[2];
+	int status;
+
+	if (pipe(fds) < 0) {
+		printf("pipe: failed\r\n");
+		return;
+	}
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		printf("pipe: fork failed\r\n");
+		close(fds[0]);
+		close(fds[1]);
+		return;
+	}
+
+	if (!pid) {
+		/* Writer */
+		close(fds[0]);
+		while (total < BENCH_PIPE_SIZE) {
+			int ret = write(fds[1], buff, sizeof(buff));
+			if (ret <= 0) {
+				break;
+			}
+			total += ret;
+		}
+		close(fds[1]);
+		_exit(0);
+	}
+
+	/* Reader, until EOF */
+	close(fds[1]);
+	clock_t start = clock();
+	while (1) {
+		int ret = read(fds[0], buff, sizeof(buff));
+		if (ret <= 0) {
+			break;
+		}
+		total += ret;
+	}
+	clock_t ticks = clock() - start;
+	close(fds[0]);
+	(void)waitpid(pid, &status, 0);
+
+	if (!ticks) {
+		ticks = 1;
+	}
+	/* Scaled down to stay within 32 bits */
+	unsigned long rate = ((total * (CLOCKS_PER_SEC / 100)) / ticks) * 100;
+	printf("pipe: %lu bytes, %lu ticks, %lu B/s\r\n", total, (unsigned long)ticks, rate);
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	bench_syscall();
+	bench_pipe();
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+/* ZAK180 User Space App
+ * FAT12 defragmenter
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+
+/* Moves every fragmented file to one contiguous run of clusters.
+ * Boot and exec time files go first and are packed from the start
+ * of the data area, right after the FAT and the root directory.
+ * The rest follows them. Seeks are jumps to another cylinder while
+ * reading a file through, reported before and after. */
+
+#define DEFRAG_PATH_MAX 64
+#define DEFRAG_DENTS    4
+
+static const char *const hot[] = { "/BOOT", "/BIN" };
+
+/* Walked in the first pass, or not on FAT (devfs) */
+static const char *const skip[] = { "/BOOT", "/BIN", "/DEV" };
+
+static struct {
+	uint8_t dry;
+	uint16_t files;
+	uint16_t moved;
+	uint16_t failed;
+	uint16_t frags_before;
+	uint16_t frags_after;
+	uint16_t seeks_before;
+	uint16_t seeks_after;
+} common;
+
+static uint8_t defrag_is_skipped(const char *path)
+{
+	for (uint8_t i = 0; i < sizeof(skip) / sizeof(skip[0]); ++i) {
+		if (!strcmp(path, skip[i])) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void defrag_file(const char *path, uint16_t from)
+{
+	struct fat_fragstat before, after;
+
+	int8_t fd = open(path, O_RDWR, 0);
+	if (fd < 0) {
+		printf("%s: open failed (%d)\r\n", path, fd);
+		++common.failed;
+		return;
+	}
+
+	if (ioctl(fd, FAT_IOC_FRAGSTAT, &before) < 0) {
+		/* Not on FAT */
+		close(fd);
+		return;
+	}
+
+	after = before;
+
+	if (!common.dry) {
+		int ret = ioctl(fd, FAT_IOC_DEFRAG, &from);
+		if (ret < 0) {
+			printf("%s: failed to move (%d)\r\n", path, ret);
+			++common.failed;
+		}
+		else if (ioctl(fd, FAT_IOC_FRAGSTAT, &after) < 0) {
+			after = before;
+		}
+	}
+
+	close(fd);
+
+	++common.files;
+	common.frags_before += before.fragments;
+	common.frags_after += after.fragments;
+	common.seeks_before += before.seeks;
+	common.seeks_after += after.seeks;
+
+	if (after.first != before.first) {
+		++common.moved;
+	}
+
+	if ((before.fragments > 1) || (after.first != before.first)) {
+		printf("%s: %u clusters, fragments %u -> %u, seeks %u -> %u\r\n", path,
+			(unsigned)before.clusters, (unsigned)before.fragments, (unsigned)after.fragments,
+			(unsigned)before.seeks, (unsigned)after.seeks);
+	}
+}
+
+/* path is extended in place, it has DEFRAG_PATH_MAX bytes */
+static void defrag_dir(char *path, uint16_t from, uint8_t top)
+{
+	struct fs_dentry dents[DEFRAG_DENTS];
+	size_t len = strlen(path);
+	int n;
+
+	int8_t dir = open(path, O_RDONLY, 0);
+	if (dir < 0) {
+		printf("%s: open failed (%d)\r\n", path, dir);
+		++common.failed;
+		return;
+	}
+
+	while ((n = getdents(dir, dents, DEFRAG_DENTS)) > 0) {
+		for (int i = 0; i < n; ++i) {
+			const char *name = dents[i].name;
+
+			if (name[0] == '.') {
+				/* Dot entries */
+				continue;
+			}
+
+			size_t pos = (len > 1) ? len : 0;
+			if (pos + 1 + strlen(name) >= DEFRAG_PATH_MAX) {
+				printf("%s/%s: path too long\r\n", path, name);
+				continue;
+			}
+
+			path[pos] = '/';
+			strcpy(path + pos + 1, name);
+
+			if (S_ISDIR(dents[i].attr)) {
+				if (!top || !defrag_is_skipped(path)) {
+					defrag_dir(path, from, 0);
+				}
+			}
+			else if (S_ISREG(dents[i].attr)) {
+				defrag_file(path, from);
+			}
+
+			path[len] = '\0';
+		}
+	}
+
+	if (n < 0) {
+		printf("%s: getdents failed (%d)\r\n", path, n);
+		++common.failed;
+	}
+
+	close(dir);
+}
+
+int main(int argc, char *argv[])
+{
+	static char path[DEFRAG_PATH_MAX];
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-n")) {
+			common.dry = 1;
+		}
+		else {
+			printf("usage: defrag [-n]\r\n  -n  report only, do not move anything\r\n");
+			return 1;
+		}
+	}
+
+	/* Cluster 2 is the first one of the data area */
+	for (uint8_t i = 0; i < sizeof(hot) / sizeof(hot[0]); ++i) {
+		strcpy(path, hot[i]);
+		defrag_dir(path, 2, 0);
+	}
+
+	strcpy(path, "/");
+	defrag_dir(path, 0, 1);
+
+	(void)sync();
+
+	printf("defrag: %u files, %u moved, %u failed\r\n", (unsigned)common.files,
+		(unsigned)common.moved, (unsigned)common.failed);
+	printf("defrag: fragments %u -> %u, seeks %u -> %u\r\n",
+		(unsigned)common.frags_before, (unsigned)common.frags_after,
+		(unsigned)common.seeks_before, (unsigned)common.seeks_after);
+
+	return common.failed ? 1 : 0;
+}
@@ -8,6 +8,7 @@
 #include <ctype.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <sys/batch.h>
 
 #define LF  0x0a
 #define CR  0x0d
@@ -24,24 +25,40 @@ int8_t shell(int argc, char *argv[])
 	char line[81];
 	uint8_t lpos = 0;
 	int8_t is_escape = 0;
+	static const char bs[] = "\b \b";
+	const char *echo = NULL;
+	uint8_t echolen = 0;
+	char c;
 
 	while (1) {
-		char c, echo = 1;
-		read(STDIN_FILENO, &c, 1);
+		/* Echo of the previous character and the next read in one syscall */
+		struct sys_batch io[2];
+		uint8_t n = 0;
+
+		if (echolen) {
+			batch_prep(&io[n++], SYS_BATCH_WRITE, STDOUT_FILENO, (void *)echo, echolen);
+		}
+		batch_prep(&io[n++], SYS_BATCH_READ, STDIN_FILENO, &c, 1);
+
+		echolen = 0;
+		if ((batch(io, n) != n) || (io[n - 1].ret != 1)) {
+			continue;
+		}
 
 		if (is_escape) {
-			echo = 0;
+			/* Ignore */
 		}
 		else if (isprint(c)) {
 			if (lpos < sizeof(line) - 1) {
 				line[lpos] = c;
 				++lpos;
 			}
+			echo = &c;
+			echolen = 1;
 		}
 		else if (c == CR) {
 			char nl[] = "\r\n";
 			write(STDOUT_FILENO, &nl, 2);
-			echo = 0;
 
 			line[lpos] = '\0';
 			process_line(line);
@@ -50,25 +67,20 @@ int8_t shell(int argc, char *argv[])
 		}
 		else if (c == LF) {
 			/* Ignore */
-			echo = 0;
 		}
 		else if (c == DEL) {
 			if (lpos) {
 				--lpos;
-				char bs[] = "\b \b";
-				write(STDOUT_FILENO, &bs, 3);
-			}
-			else {
-				echo = 0;
+				echo = bs;
+				echolen = 3;
 			}
 		}
 		else if (c == ESC) {
 			is_escape = 1;
-			echo = 0;
 		}
-
-		if (echo) {
-			write(STDOUT_FILENO, &c, 1);
+		else {
+			echo = &c;
+			echolen = 1;
 		}
 	}
 
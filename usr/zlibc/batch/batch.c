@@ -0,0 +1,24 @@
+/* ZAK180 Zlibc
+ * batch.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <sys/batch.h>
+#include <sys/syscall.h>
+
+void batch_prep(struct sys_batch *entry, uint8_t op, int8_t fd, void *buff, size_t len)
+{
+	entry->op = op;
+	entry->fd = fd;
+	entry->buff = buff;
+	entry->len = len;
+	entry->ret = 0;
+}
+
+int batch(struct sys_batch *entries, uint8_t count)
+{
+	int ret = __sys_batch(entries, count);
+	return ret;
+}
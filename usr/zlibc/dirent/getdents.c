@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * getdents.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+
+int getdents(int8_t dir, struct fs_dentry *dentries, uint8_t count)
+{
+	int ret = __sys_getdents(dir, dentries, count);
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * fallocate.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+
+int fallocate(int8_t fd, off_t len)
+{
+	int ret = __sys_fallocate(fd, len);
+	return ret;
+}
@@ -37,4 +37,9 @@
 #define O_NONBLOCK 0x40
 #define O_ACCMODE  0x7F
 
+/* lseek whence */
+#define SEEK_SET 0
+#define SEEK_CUR 1
+#define SEEK_END 2
+
 #endif
@@ -0,0 +1,27 @@
+/* ZAK180 Firmaware
+ * Batched syscalls
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_BITS_SYS_BATCH_H_
+#define __ZLIBC_BITS_SYS_BATCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SYS_BATCH_READ  0
+#define SYS_BATCH_WRITE 1
+#define SYS_BATCH_CLOSE 2
+
+/* Entries are executed in order, execution stops
+ * after the first entry that failed */
+struct sys_batch {
+	uint8_t op;
+	int8_t fd;
+	void *buff;
+	size_t len;
+	int16_t ret;
+};
+
+#endif
@@ -0,0 +1,54 @@
+/* ZAK180 Firmaware
+ * ioctl
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_BITS_SYS_IOCTL_H_
+#define __ZLIBC_BITS_SYS_IOCTL_H_
+
+#include <stdint.h>
+
+/* Request encoding: direction (2 bits), argument size (6 bits), number.
+ * The kernel copies the argument in/out, drivers get a kernel pointer. */
+#define IOC_NONE 0
+#define IOC_IN   1
+#define IOC_OUT  2
+#define IOC_INOUT (IOC_IN | IOC_OUT)
+
+#define IOC(dir, size, nr) ((int16_t)(((uint16_t)(dir) << 14) | ((uint16_t)(size) << 8) | (nr)))
+#define IOC_DIR(op)        (((uint16_t)(op) >> 14) & 0x03)
+#define IOC_SIZE(op)       (((uint16_t)(op) >> 8) & 0x3F)
+
+#define IOC_SIZE_MAX 0x3F
+
+/* UART read mode, termios VMIN/VTIME alike:
+ * vmin  - bytes to wait for (capped at the read length),
+ * vtime - inter-byte timeout in ms once something was received
+ *         (whole read timeout if vmin is 0), 0 - none.
+ * Default is vmin = 0xFFFF, vtime = 0 - fill the whole buffer. */
+struct uart_mode {
+	uint16_t vmin;
+	uint16_t vtime;
+};
+
+#define UART_IOC_GETMODE IOC(IOC_OUT, sizeof(struct uart_mode), 0x01)
+#define UART_IOC_SETMODE IOC(IOC_IN, sizeof(struct uart_mode), 0x02)
+
+/* FAT file layout: clusters in the chain, contiguous runs, jumps
+ * to another cylinder while reading it through, first cluster */
+struct fat_fragstat {
+	uint16_t clusters;
+	uint16_t fragments;
+	uint16_t seeks;
+	uint16_t first;
+};
+
+#define FAT_IOC_FRAGSTAT IOC(IOC_OUT, sizeof(struct fat_fragstat), 0x10)
+/* Moves a regular file to one contiguous run of free clusters, searched
+ * for from the given cluster on (0 - allocation hint, contiguous files
+ * are left alone then). -ENOSPC if there is no run long enough,
+ * -EBADF if the file is not open for writing. */
+#define FAT_IOC_DEFRAG   IOC(IOC_IN, sizeof(uint16_t), 0x11)
+
+#endif
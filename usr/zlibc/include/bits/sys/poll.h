@@ -0,0 +1,26 @@
+/* ZAK180 Firmaware
+ * Poll
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_BITS_SYS_POLL_H_
+#define __ZLIBC_BITS_SYS_POLL_H_
+
+#include <stdint.h>
+
+#define POLLIN   0x01
+#define POLLOUT  0x02
+#define POLLERR  0x04
+#define POLLHUP  0x08
+#define POLLNVAL 0x10
+
+#define POLL_FDS_MAX 8
+
+struct pollfd {
+	int8_t fd;
+	uint8_t events;
+	uint8_t revents;
+};
+
+#endif
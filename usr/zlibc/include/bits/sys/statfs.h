@@ -0,0 +1,18 @@
+/* ZAK180 Firmaware
+ * File system statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_BITS_SYS_STATFS_H_
+#define __ZLIBC_BITS_SYS_STATFS_H_
+
+#include <stdint.h>
+
+struct statfs {
+	uint16_t f_bsize;  /* Allocation unit (cluster) size in bytes */
+	uint16_t f_blocks; /* Data clusters in total */
+	uint16_t f_bfree;  /* Free clusters */
+};
+
+#endif
@@ -0,0 +1,19 @@
+/* ZAK180 Firmaware
+ * Vectored I/O
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_BITS_SYS_UIO_H_
+#define __ZLIBC_BITS_SYS_UIO_H_
+
+#include <stddef.h>
+
+#define IOV_MAX 16
+
+struct iovec {
+	void *iov_base;
+	size_t iov_len;
+};
+
+#endif
@@ -11,4 +11,9 @@
 
 typedef int64_t time_t;
 
+/* Kernel time stamp, PRT0 ticks */
+typedef uint32_t clock_t;
+
+#define CLOCKS_PER_SEC 307200UL
+
 #endif
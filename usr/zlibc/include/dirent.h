@@ -0,0 +1,18 @@
+/* ZAK180 Zlibc
+ * dirent
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_DIRENT_H_
+#define __ZLIBC_DIRENT_H_
+
+#include <stdint.h>
+#include <bits/sys/fs.h>
+
+/* Reads up to count entries of an open directory, continues
+ * where the previous call stopped. Returns number of entries,
+ * 0 at the end of the directory. */
+int getdents(int8_t dir, struct fs_dentry *dentries, uint8_t count);
+
+#endif
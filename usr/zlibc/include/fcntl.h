@@ -8,8 +8,12 @@
 #define __ZLIBC_FCNTL_H_
 
 #include <stdint.h>
+#include <sys/types.h>
 #include <bits/fcntl.h>
 
 int open(const char *path, uint8_t mode, uint8_t attr);
+/* Reserves contiguous space for len bytes, file size is not changed.
+ * Whatever has not been written is given back on the last close. */
+int fallocate(int8_t fd, off_t len);
 
 #endif
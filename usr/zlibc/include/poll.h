@@ -0,0 +1,16 @@
+/* ZAK180 Zlibc
+ * poll
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef __ZLIBC_POLL_H_
+#define __ZLIBC_POLL_H_
+
+#include <stdint.h>
+#include <bits/sys/poll.h>
+
+/* timeout in ms, negative - infinite */
+int poll(struct pollfd *fds, uint8_t nfds, int16_t timeout);
+
+#endif
@@ -0,0 +1,19 @@
+/* ZAK180 Zlibc
+ * Batched syscalls
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef _ZLIBC_BATCH_H_
+#define _ZLIBC_BATCH_H_
+
+#include <stdint.h>
+#include <bits/sys/batch.h>
+
+void batch_prep(struct sys_batch *entry, uint8_t op, int8_t fd, void *buff, size_t len);
+
+/* Returns number of executed entries (the last one might have
+ * failed, see its ret) or a negative error */
+int batch(struct sys_batch *entries, uint8_t count);
+
+#endif
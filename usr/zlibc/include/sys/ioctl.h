@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * ioctl
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef _ZLIBC_IOCTL_H_
+#define _ZLIBC_IOCTL_H_
+
+#include <stdint.h>
+#include <bits/sys/ioctl.h>
+
+int ioctl(int8_t fd, int16_t op, void *arg);
+
+#endif
@@ -0,0 +1,14 @@
+/* ZAK180 Zlibc
+ * File system statistics
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef _ZLIBC_STATFS_H_
+#define _ZLIBC_STATFS_H_
+
+#include <bits/sys/statfs.h>
+
+int statfs(const char *path, struct statfs *buf);
+
+#endif
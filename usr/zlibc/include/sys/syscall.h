@@ -10,6 +10,9 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <sys/types.h>
+#include <bits/sys/batch.h>
+#include <bits/sys/uio.h>
+#include <bits/sys/poll.h>
 
 int __sys_execv(const char *path, char *const argv[]) __sdcccall(0);
 void __sys_exit(int exit) __sdcccall(0);
@@ -26,5 +29,27 @@ int __sys_ftruncate(int8_t fd, off_t size) __sdcccall(0);
 int __sys_readdir(int8_t dir, struct fs_dentry *dentry, uint16_t idx) __sdcccall(0);
 int __sys_remove(const char *path) __sdcccall(0);
 int __sys_dup2(int8_t oldfd, int8_t newfd) __sdcccall(0);
+uint32_t __sys_time(void) __sdcccall(0);
+int __sys_batch(struct sys_batch *entries, uint8_t count) __sdcccall(0);
+int __sys_readv(int8_t fd, const struct iovec *iov, uint8_t iovcnt) __sdcccall(0);
+int __sys_writev(int8_t fd, const struct iovec *iov, uint8_t iovcnt) __sdcccall(0);
+int __sys_lseek(int8_t fd, off_t *offset, int8_t whence) __sdcccall(0);
+int __sys_pread(int8_t fd, void *buff, size_t bufflen, off_t offset) __sdcccall(0);
+int __sys_pwrite(int8_t fd, const void *buff, size_t bufflen, off_t offset) __sdcccall(0);
+int __sys_poll(struct pollfd *fds, uint8_t nfds, int16_t timeout) __sdcccall(0);
+int __sys_ioctl(int8_t fd, int16_t op, void *arg) __sdcccall(0);
+int __sys_pipe(int8_t fds[2]) __sdcccall(0);
+int __sys_sendfile(int8_t outfd, int8_t infd, off_t *offs, size_t count) __sdcccall(0);
+int __sys_getdents(int8_t dir, struct fs_dentry *dentries, uint8_t count) __sdcccall(0);
+int __sys_statfs(const char *path, struct statfs *buf) __sdcccall(0);
+int __sys_sync(void) __sdcccall(0);
+int __sys_fsync(int8_t fd) __sdcccall(0);
+int __sys_fallocate(int8_t fd, off_t len) __sdcccall(0);
+
+/* Register based entry, no stack frame copy on the kernel side */
+int16_t __fsys_msleep(uint16_t mseconds) __sdcccall(1);
+int16_t __fsys_read(int16_t fd, void *buff, size_t bufflen) __sdcccall(1);
+int16_t __fsys_write(int16_t fd, const void *buff, size_t bufflen) __sdcccall(1);
+uint32_t __fsys_time(void) __sdcccall(1);
 
 #endif
@@ -0,0 +1,16 @@
+/* ZAK180 Zlibc
+ * Vectored I/O
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#ifndef _ZLIBC_UIO_H_
+#define _ZLIBC_UIO_H_
+
+#include <stdint.h>
+#include <bits/sys/uio.h>
+
+int readv(int8_t fd, const struct iovec *iov, uint8_t iovcnt);
+int writev(int8_t fd, const struct iovec *iov, uint8_t iovcnt);
+
+#endif
@@ -9,4 +9,6 @@
 
 #include <bits/time.h>
 
+clock_t clock(void);
+
 #endif
@@ -13,6 +13,7 @@
 
 #include <stddef.h>
 #include <sys/types.h>
+#include <bits/fcntl.h>
 
 int close(int8_t fd);
 int8_t execv(const char *path, char *const argv[]);
@@ -21,10 +22,17 @@ pid_t fork(void);
 int8_t msleep(mseconds_t time);
 int read(int8_t fd, void *buff, size_t bufflen);
 int write(int8_t fd, const void *buff, size_t bufflen);
+off_t lseek(int8_t fd, off_t offset, int8_t whence);
+int pread(int8_t fd, void *buff, size_t bufflen, off_t offset);
+int pwrite(int8_t fd, const void *buff, size_t bufflen, off_t offset);
 int truncate(const char *path, off_t size);
 int ftruncate(int8_t fd, off_t size);
 int remove(const char *path);
 int dup(int8_t oldfd);
 int dup2(int8_t oldfd, int8_t newfd);
+int pipe(int8_t fds[2]);
+int sendfile(int8_t outfd, int8_t infd, off_t *offs, size_t count);
+int sync(void);
+int fsync(int8_t fd);
 
 #endif
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * ioctl.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+int ioctl(int8_t fd, int16_t op, void *arg)
+{
+	int ret = __sys_ioctl(fd, op, arg);
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * poll.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <poll.h>
+#include <sys/syscall.h>
+
+int poll(struct pollfd *fds, uint8_t nfds, int16_t timeout)
+{
+	int ret = __sys_poll(fds, nfds, timeout);
+	return ret;
+}
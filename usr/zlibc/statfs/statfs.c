@@ -0,0 +1,14 @@
+/* ZAK180 Zlibc
+ * statfs.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <sys/statfs.h>
+#include <sys/syscall.h>
+
+int statfs(const char *path, struct statfs *buf)
+{
+	int ret = __sys_statfs(path, buf);
+	return ret;
+}
@@ -8,6 +8,6 @@
 
 int putchar(int c)
 {
-	char sc = (char)c; /* Make sure the pointer is to the stack */
+	char sc = (char)c;
 	return write(STDOUT_FILENO, &sc, 1);
 }
@@ -75,3 +75,117 @@ ___sys_remove:
 ___sys_dup2:
 			ld a, #13
 			rst 0x38
+
+.globl ___sys_time
+___sys_time:
+			ld a, #14
+			rst 0x38
+
+.globl ___sys_batch
+___sys_batch:
+			ld a, #15
+			rst 0x38
+
+.globl ___sys_readv
+___sys_readv:
+			ld a, #16
+			rst 0x38
+
+.globl ___sys_writev
+___sys_writev:
+			ld a, #17
+			rst 0x38
+
+.globl ___sys_lseek
+___sys_lseek:
+			ld a, #18
+			rst 0x38
+
+.globl ___sys_pread
+___sys_pread:
+			ld a, #19
+			rst 0x38
+
+.globl ___sys_pwrite
+___sys_pwrite:
+			ld a, #20
+			rst 0x38
+
+.globl ___sys_poll
+___sys_poll:
+			ld a, #21
+			rst 0x38
+
+.globl ___sys_ioctl
+___sys_ioctl:
+			ld a, #22
+			rst 0x38
+
+.globl ___sys_pipe
+___sys_pipe:
+			ld a, #23
+			rst 0x38
+
+.globl ___sys_sendfile
+___sys_sendfile:
+			ld a, #24
+			rst 0x38
+
+.globl ___sys_getdents
+___sys_getdents:
+			ld a, #25
+			rst 0x38
+
+.globl ___sys_statfs
+___sys_statfs:
+			ld a, #26
+			rst 0x38
+
+.globl ___sys_sync
+___sys_sync:
+			ld a, #27
+			rst 0x38
+
+.globl ___sys_fsync
+___sys_fsync:
+			ld a, #28
+			rst 0x38
+
+.globl ___sys_fallocate
+___sys_fallocate:
+			ld a, #29
+			rst 0x38
+
+; Register based (rst 0x30) __sdcccall(1) entries.
+; Kernel returns here, stack arguments are removed
+; by the callee.
+
+.globl ___fsys_msleep
+___fsys_msleep:
+			ld a, #3
+			rst 0x30
+			ret
+
+.globl ___fsys_read
+___fsys_read:
+			ld a, #7
+			rst 0x30
+			pop hl
+			inc sp
+			inc sp
+			jp (hl)
+
+.globl ___fsys_write
+___fsys_write:
+			ld a, #8
+			rst 0x30
+			pop hl
+			inc sp
+			inc sp
+			jp (hl)
+
+.globl ___fsys_time
+___fsys_time:
+			ld a, #14
+			rst 0x30
+			ret
@@ -0,0 +1,14 @@
+/* ZAK180 Zlibc
+ * clock.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <time.h>
+#include <sys/syscall.h>
+
+clock_t clock(void)
+{
+	clock_t ret = __fsys_time();
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * readv.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+
+int readv(int8_t fd, const struct iovec *iov, uint8_t iovcnt)
+{
+	int ret = __sys_readv(fd, iov, iovcnt);
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * writev.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+
+int writev(int8_t fd, const struct iovec *iov, uint8_t iovcnt)
+{
+	int ret = __sys_writev(fd, iov, iovcnt);
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * fsync.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int fsync(int8_t fd)
+{
+	int ret = __sys_fsync(fd);
+	return ret;
+}
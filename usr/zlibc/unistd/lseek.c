@@ -0,0 +1,21 @@
+/* ZAK180 Zlibc
+ * lseek.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+off_t lseek(int8_t fd, off_t offset, int8_t whence)
+{
+	/* Offset is passed both ways through memory, so the syscall
+	 * return value stays a plain error code */
+	int ret = __sys_lseek(fd, &offset, whence);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return offset;
+}
@@ -10,6 +10,6 @@
 
 int8_t msleep(mseconds_t time)
 {
-	int8_t ret = __sys_msleep(time);
+	int8_t ret = __fsys_msleep(time);
 	return ret;
 }
@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * pipe.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int pipe(int8_t fds[2])
+{
+	int ret = __sys_pipe(fds);
+	return ret;
+}
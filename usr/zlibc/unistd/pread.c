@@ -0,0 +1,16 @@
+/* ZAK180 Zlibc
+ * pread.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int pread(int8_t fd, void *buff, size_t bufflen, off_t offset)
+{
+	int ret = __sys_pread(fd, buff, bufflen, offset);
+	return ret;
+}
@@ -0,0 +1,16 @@
+/* ZAK180 Zlibc
+ * pwrite.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int pwrite(int8_t fd, const void *buff, size_t bufflen, off_t offset)
+{
+	int ret = __sys_pwrite(fd, buff, bufflen, offset);
+	return ret;
+}
@@ -10,6 +10,6 @@
 
 int read(int8_t fd, void *buff, size_t bufflen)
 {
-	int ret = __sys_read(fd, buff, bufflen);
+	int ret = __fsys_read(fd, buff, bufflen);
 	return ret;
 }
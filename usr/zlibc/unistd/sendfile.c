@@ -0,0 +1,15 @@
+/* ZAK180 Zlibc
+ * sendfile.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int sendfile(int8_t outfd, int8_t infd, off_t *offs, size_t count)
+{
+	int ret = __sys_sendfile(outfd, infd, offs, count);
+	return ret;
+}
@@ -0,0 +1,14 @@
+/* ZAK180 Zlibc
+ * sync.c
+ * Copyright: Aleksander Kaminski, 2025
+ * See LICENSE.md
+ */
+
+#include <unistd.h>
+#include <sys/syscall.h>
+
+int sync(void)
+{
+	int ret = __sys_sync();
+	return ret;
+}
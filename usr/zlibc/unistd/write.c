@@ -10,6 +10,6 @@
 
 int write(int8_t fd, const void *buff, size_t bufflen)
 {
-	int ret = __sys_write(fd, buff, bufflen);
+	int ret = __fsys_write(fd, buff, bufflen);
 	return ret;
 }